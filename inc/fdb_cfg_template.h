@@ -18,6 +18,38 @@
 #ifdef FDB_USING_KVDB
 /* Auto update KV to latest default when current KVDB version number is changed. @see fdb_kvdb.ver_num */
 /* #define FDB_KV_AUTO_UPDATE */
+
+/* Index all KV in a RAM hash table when database initialization, it will replace the KV cache.
+ * The size MUST be the Nth power of 2 and more than the max KV number. It costs 8 bytes RAM for each node. */
+/* #define FDB_KV_INDEX_TABLE_SIZE        256 */
+
+/* Keep the status and remain space of all sectors in a RAM table, the KV allocation will NOT read the sector header.
+ * The size MUST be more than or equal to the sector number. It needs the KV cache. */
+/* #define FDB_KV_SECTOR_TABLE_SIZE       16 */
+
+/* Keep a RAM summary (bloom filter of KV name) for each sector, the KV finding will skip the sector which has no the KV.
+ * The table size should be more than or equal to the sector number. */
+/* #define FDB_KV_SECTOR_SUMMARY_TABLE_SIZE 16 */
+/* the bloom filter size (bytes) of each sector summary, default is 32 */
+/* #define FDB_KV_BLOOM_FILTER_SIZE       32 */
+/* Select the GC sector by the cost-benefit score of the live and dead KV size in sector summary, it will move less KV
+ * than the oldest sector first GC. It needs the FDB_KV_SECTOR_SUMMARY_TABLE_SIZE. */
+/* #define FDB_KV_GC_COST_BENEFIT */
+
+/* Cache the recently missed KV name, finding a missed KV again will NOT read the flash. */
+/* #define FDB_KV_MISS_CACHE_TABLE_SIZE   16 */
+
+/* Save the set KV in a RAM write buffer (bytes) first, it will be flushed to flash when the buffer is full,
+ * a set/get/del API is called after the flush timeout or fdb_kvdb_flush is called. NOTE: The buffered KV will be lost
+ * after power off, and the timeout is not checked while the database is idle, so call fdb_kvdb_flush in a timer. */
+/* #define FDB_KV_WRITE_BUF_SIZE          512 */
+
+/* The buffer size (bytes) when moving the KV by GC, default is 32. It MUST be aligned by 4 and the write granularity. */
+/* #define FDB_KV_MOVE_BUF_SIZE           256 */
+
+/* The staging buffer size (bytes) when creating the KV, default is 64. The KV header, name and value are merged in it.
+ * It MUST be aligned by 4 and the write granularity. */
+/* #define FDB_KV_STAGE_BUF_SIZE          128 */
 #endif
 
 /* using TSDB (Time series database) feature */
@@ -29,6 +61,18 @@
  * Warning: If defined will be incompatible with variable blob flash store or if fixed blob size is later changed */
 /* #define FDB_TSDB_FIXED_BLOB_SIZE 4 */
 
+/* The TSDB sector index table size, it MUST be more than or equal to the TSDB sector number.
+ * The time range of each sector is kept in RAM, the TSL query by time will find the start sector by binary search. */
+/* #define FDB_TSDB_SECTOR_INDEX_TABLE_SIZE 64 */
+
+/* The aggregate summary (count/min/max/sum) of each TSDB sector is kept in RAM, it needs the TSDB sector index.
+ * The fdb_tsl_aggregate only scans the TSL in the sectors which are partially in the time range. */
+/* #define FDB_TSDB_USING_AGGR_SUMMARY */
+
+/* The TSL number of each status in each TSDB sector is kept in RAM, it needs the TSDB sector index.
+ * The fdb_tsl_query_count only scans the TSL in the sectors which are partially in the time range. */
+/* #define FDB_TSDB_USING_STATUS_COUNT */
+
 /* Using FAL storage mode */
 #define FDB_USING_FAL_MODE
 
@@ -36,6 +80,9 @@
 /* the flash write granularity, unit: bit
  * only support 1(nor flash)/ 8(stm32f2/f4)/ 32(stm32f1)/ 64(stm32f7)/ 128(stm32h5)/ 256(stm32h7) */
 #define FDB_WRITE_GRAN                /* @note you must define it for a value */
+
+/* The FAL flash device is memory mapped (internal flash, XIP NOR flash or RAM), the flash data can be accessed by address */
+/* #define FDB_USING_FAL_XIP */
 #endif
 
 /* Using file storage mode by LIBC file API, like fopen/fread/fwrte/fclose */
@@ -44,6 +91,28 @@
 /* Using file storage mode by POSIX file API, like open/read/write/close */
 /* #define FDB_USING_FILE_POSIX_MODE */
 
+/* Save the whole database in one preallocated file by POSIX pread/pwrite API, it MUST be used with FDB_USING_FILE_POSIX_MODE */
+/* #define FDB_USING_FILE_POSIX_SINGLE_MODE */
+
+/* Map the single database file into memory by mmap, it MUST be used with FDB_USING_FILE_POSIX_MODE */
+/* #define FDB_USING_FILE_MMAP_MODE */
+
+/* Sync the files of many databases concurrently by Linux io_uring in fdb_db_sync_multi,
+ * it MUST be used with FDB_USING_FILE_POSIX_MODE and without FDB_USING_FILE_MMAP_MODE */
+/* #define FDB_USING_FILE_IO_URING */
+
+/* CRC32 algorithm, default is using 1KB table for each byte. The polynomial is same for all algorithms.
+ * slicing-by-8: using 8KB table (in ROM), it's about 5 times faster. */
+/* #define FDB_CRC32_USING_SLICING_BY_8 */
+/* x86-64 carry-less multiplication (PCLMUL), it's used when data size >= 64. Compile with -mpclmul -msse4.1 */
+/* #define FDB_CRC32_USING_PCLMUL */
+/* implement the fdb_calc_crc32() by user, such as the CRC hardware unit */
+/* #define FDB_CRC32_USING_USER */
+
+/* The block size (bytes) of the write-through RAM block cache, default is 0 (disabled). The cache memory is set by the
+ * FDB_KVDB_CTRL_SET_BLOCK_CACHE/FDB_TSDB_CTRL_SET_BLOCK_CACHE control command. The sector size MUST be aligned by it. */
+/* #define FDB_BLOCK_CACHE_BLOCK_SIZE     64 */
+
 /* MCU Endian Configuration, default is Little Endian Order. */
 /* #define FDB_BIG_ENDIAN */ 
 
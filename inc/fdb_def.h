@@ -43,15 +43,121 @@ extern "C" {
 #define FDB_KV_USING_CACHE
 #endif
 
+/* the KV hash index table size, 0: disable. It MUST be the Nth power of 2 and more than the max KV number.
+ * The index will replace the KV cache table, all KV are indexed when database initialization. */
+#ifndef FDB_KV_INDEX_TABLE_SIZE
+#define FDB_KV_INDEX_TABLE_SIZE        0
+#endif
+
+#if FDB_KV_INDEX_TABLE_SIZE > 0
+#define FDB_KV_USING_INDEX
+#endif
+
+/* the KV sector table size, 0: disable. It MUST be more than or equal to the KVDB sector number.
+ * The status and remain space of all sectors are kept in RAM, the KV allocation will NOT read the sector header. */
+#ifndef FDB_KV_SECTOR_TABLE_SIZE
+#define FDB_KV_SECTOR_TABLE_SIZE       0
+#endif
+
+#if FDB_KV_SECTOR_TABLE_SIZE > 0
+#define FDB_KV_USING_SECTOR_TABLE
+#endif
+
+/* the KV sector summary table size, 0: disable. It should be more than or equal to the KVDB sector number.
+ * Each sector summary has a bloom filter of the KV name, the sector will be skipped when finding a KV which is NOT in it. */
+#ifndef FDB_KV_SECTOR_SUMMARY_TABLE_SIZE
+#define FDB_KV_SECTOR_SUMMARY_TABLE_SIZE 0
+#endif
+
+/* the bloom filter size (bytes) of each KV sector summary */
+#ifndef FDB_KV_BLOOM_FILTER_SIZE
+#define FDB_KV_BLOOM_FILTER_SIZE       32
+#endif
+
+#if FDB_KV_SECTOR_SUMMARY_TABLE_SIZE > 0
+#define FDB_KV_USING_SECTOR_SUMMARY
+#endif
+
+/* the KV miss cache table size, 0: disable. It caches the recently missed KV name, finding it again will NOT read flash */
+#ifndef FDB_KV_MISS_CACHE_TABLE_SIZE
+#define FDB_KV_MISS_CACHE_TABLE_SIZE   0
+#endif
+
+#if FDB_KV_MISS_CACHE_TABLE_SIZE > 0
+#define FDB_KV_USING_MISS_CACHE
+#endif
+
+/* the KV write buffer size (bytes), 0: disable. The set KV is saved in RAM write buffer first, then flushed to flash
+ * when the buffer is full, a set/get/del API is called after the flush timeout or fdb_kvdb_flush is called. */
+#ifndef FDB_KV_WRITE_BUF_SIZE
+#define FDB_KV_WRITE_BUF_SIZE          0
+#endif
+
+#if FDB_KV_WRITE_BUF_SIZE > 0
+#define FDB_KV_USING_WRITE_BUF
+#endif
+
+/* the TSDB sector index table size, 0: disable. It MUST be more than or equal to the TSDB sector number.
+ * The time range of all sectors are kept in RAM, the TSL query by time will find the start sector by binary search. */
+#ifndef FDB_TSDB_SECTOR_INDEX_TABLE_SIZE
+#define FDB_TSDB_SECTOR_INDEX_TABLE_SIZE 0
+#endif
+
+#if FDB_TSDB_SECTOR_INDEX_TABLE_SIZE > 0
+#define FDB_TSDB_USING_SECTOR_INDEX
+#endif
+
+/* the max size (bytes) of the log head which is read for the TSL aggregate value get function */
+#ifndef FDB_TSDB_AGGR_LOG_SIZE
+#define FDB_TSDB_AGGR_LOG_SIZE         16
+#endif
+
+/* the block size (bytes) of the RAM block cache between the database and the storage, 0: disable.
+ * The cache memory is supplied by the FDB_KVDB_CTRL_SET_BLOCK_CACHE/FDB_TSDB_CTRL_SET_BLOCK_CACHE control command. */
+#ifndef FDB_BLOCK_CACHE_BLOCK_SIZE
+#define FDB_BLOCK_CACHE_BLOCK_SIZE     0
+#endif
+
+#if FDB_BLOCK_CACHE_BLOCK_SIZE > 0
+#define FDB_USING_BLOCK_CACHE
+#endif
+
+#if defined(FDB_USING_FAL_XIP) && !defined(FDB_USING_FAL_MODE)
+#error "The FDB_USING_FAL_XIP MUST be used with FDB_USING_FAL_MODE"
+#endif
+
+/* the mmap file mode is based on the single file POSIX mode */
+#if defined(FDB_USING_FILE_MMAP_MODE) && !defined(FDB_USING_FILE_POSIX_SINGLE_MODE)
+#define FDB_USING_FILE_POSIX_SINGLE_MODE
+#endif
+
 #if defined(FDB_USING_FILE_LIBC_MODE) || defined(FDB_USING_FILE_POSIX_MODE)
 #define FDB_USING_FILE_MODE
 #endif
 
+#if defined(FDB_USING_FILE_POSIX_SINGLE_MODE) && !defined(FDB_USING_FILE_POSIX_MODE)
+#error "The FDB_USING_FILE_POSIX_SINGLE_MODE MUST be used with FDB_USING_FILE_POSIX_MODE"
+#endif
+
+#if defined(FDB_USING_FILE_IO_URING) && (!defined(FDB_USING_FILE_POSIX_MODE) || defined(FDB_USING_FILE_MMAP_MODE))
+#error "The FDB_USING_FILE_IO_URING MUST be used with FDB_USING_FILE_POSIX_MODE and without FDB_USING_FILE_MMAP_MODE"
+#endif
+
 /* the file cache table size, it will improve GC speed in file mode when using cache */
 #ifndef FDB_FILE_CACHE_TABLE_SIZE
 #define FDB_FILE_CACHE_TABLE_SIZE    2
 #endif
 
+#ifdef FDB_USING_FILE_IO_URING
+/* the io_uring queue size, it's the max number of the files which are synced by one submission */
+#ifndef FDB_FILE_IO_URING_ENTRIES
+#define FDB_FILE_IO_URING_ENTRIES    64
+#endif
+#if FDB_FILE_IO_URING_ENTRIES < FDB_FILE_CACHE_TABLE_SIZE
+#error "The FDB_FILE_IO_URING_ENTRIES MUST NOT be less than FDB_FILE_CACHE_TABLE_SIZE"
+#endif
+#endif /* FDB_USING_FILE_IO_URING */
+
 #ifndef FDB_WRITE_GRAN
 #define FDB_WRITE_GRAN 1
 #endif
@@ -88,9 +194,14 @@ if (!(EXPR))                                                                  \
 #define FDB_KVDB_CTRL_GET_SEC_SIZE     0x01             /**< get sector size control command */
 #define FDB_KVDB_CTRL_SET_LOCK         0x02             /**< set lock function control command */
 #define FDB_KVDB_CTRL_SET_UNLOCK       0x03             /**< set unlock function control command */
+#define FDB_KVDB_CTRL_SET_GET_TIME     0x04             /**< set the current timestamp get function control command, it's used by the write buffer flush timeout */
+#define FDB_KVDB_CTRL_SET_FLUSH_TIMEOUT 0x05            /**< set the write buffer flush timeout control command, 0: disable */
 #define FDB_KVDB_CTRL_SET_FILE_MODE    0x09             /**< set file mode control command, this change MUST before database initialization */
 #define FDB_KVDB_CTRL_SET_MAX_SIZE     0x0A             /**< set database max size in file mode control command, this change MUST before database initialization */
 #define FDB_KVDB_CTRL_SET_NOT_FORMAT   0x0B             /**< set database NOT format mode control command, this change MUST before database initialization */
+#define FDB_KVDB_CTRL_SET_DURABILITY   0x0C             /**< set durability level in file mode control command, @see fdb_durability_t */
+#define FDB_KVDB_CTRL_SET_GROUP_SYNC   0x0D             /**< set the sync interval (write number) of the group commit durability control command */
+#define FDB_KVDB_CTRL_SET_BLOCK_CACHE  0x0E             /**< set block cache memory control command, @see fdb_block_cache_mem, this change MUST before database initialization */
 
 #define FDB_TSDB_CTRL_SET_SEC_SIZE     0x00             /**< set sector size control command, this change MUST before database initialization */
 #define FDB_TSDB_CTRL_GET_SEC_SIZE     0x01             /**< get sector size control command */
@@ -102,6 +213,10 @@ if (!(EXPR))                                                                  \
 #define FDB_TSDB_CTRL_SET_FILE_MODE    0x09             /**< set file mode control command, this change MUST before database initialization */
 #define FDB_TSDB_CTRL_SET_MAX_SIZE     0x0A             /**< set database max size in file mode control command, this change MUST before database initialization */
 #define FDB_TSDB_CTRL_SET_NOT_FORMAT   0x0B             /**< set database NOT formatable mode control command, this change MUST before database initialization */
+#define FDB_TSDB_CTRL_SET_DURABILITY   0x0C             /**< set durability level in file mode control command, @see fdb_durability_t */
+#define FDB_TSDB_CTRL_SET_GROUP_SYNC   0x0D             /**< set the sync interval (write number) of the group commit durability control command */
+#define FDB_TSDB_CTRL_SET_BLOCK_CACHE  0x0E             /**< set block cache memory control command, @see fdb_block_cache_mem, this change MUST before database initialization */
+#define FDB_TSDB_CTRL_SET_AGGR_VALUE   0x0F             /**< set the value get function of the TSL aggregate control command, @see fdb_tsl_get_value */
 
 #ifdef FDB_USING_TIMESTAMP_64BIT
     typedef int64_t fdb_time_t;
@@ -161,6 +276,7 @@ typedef enum fdb_tsl_status fdb_tsl_status_t;
 struct fdb_kv {
     fdb_kv_status_t status;                      /**< node status, @see fdb_kv_status_t */
     bool crc_is_ok;                              /**< node CRC32 check is OK */
+    bool crc_is_checked;                         /**< node CRC32 has been checked, the crc_is_ok is assumed when it's false */
     uint8_t name_len;                            /**< name length */
     uint32_t magic;                              /**< magic word(`K`, `V`, `4`, `0`) */
     uint32_t len;                                /**< node total length (header + name + value), must align by FDB_WRITE_GRAN */
@@ -196,11 +312,41 @@ struct fdb_tsl {
 typedef struct fdb_tsl *fdb_tsl_t;
 typedef bool (*fdb_tsl_cb)(fdb_tsl_t tsl, void *arg);
 
+/* time series log cursor, it can be saved by the time member, and resumed by fdb_tsl_cursor_seek */
+struct fdb_tsl_cursor {
+    struct fdb_tsl curr_tsl;                     /**< Current TSL we get from the cursor */
+    fdb_time_t time;                             /**< Cursor position, the next TSL is NOT earlier than this timestamp */
+    uint32_t idx_addr;                           /**< The next TSL index address. DO NOT touch it. */
+    uint32_t generation;                         /**< The database generation when the address is got. DO NOT touch it. */
+};
+typedef struct fdb_tsl_cursor *fdb_tsl_cursor_t;
+
+/* time series log aggregate result, @see fdb_tsl_aggregate */
+struct fdb_tsl_aggr {
+    size_t count;                                /**< the number of aggregated TSL */
+    double min;                                  /**< the minimum value, it's valid when count is NOT 0 */
+    double max;                                  /**< the maximum value, it's valid when count is NOT 0 */
+    double sum;                                  /**< the sum of values */
+};
+typedef struct fdb_tsl_aggr *fdb_tsl_aggr_t;
+/* get the aggregate value from the log head (at most FDB_TSDB_AGGR_LOG_SIZE bytes), false: the TSL is NOT aggregated */
+typedef bool (*fdb_tsl_get_value)(const void *log, size_t len, double *value);
+
 typedef enum {
     FDB_DB_TYPE_KV,
     FDB_DB_TYPE_TS,
 } fdb_db_type;
 
+/*
+ * the durability level of the written data in file mode. The unsynced writes may reach the storage in any order
+ * on the relaxed levels, so a crash may lose both of the old and new value of a changed KV.
+ */
+typedef enum {
+    FDB_DURABILITY_STRICT,                       /**< sync the file at each status change, it's the default level */
+    FDB_DURABILITY_GROUP,                        /**< sync the file once every group sync number of status changes */
+    FDB_DURABILITY_NONE,                         /**< never sync the file, only sync it by fdb_db_sync */
+} fdb_durability_t;
+
 /* the flash sector store status */
 enum fdb_sector_store_status {
     FDB_SECTOR_STORE_UNUSED,
@@ -252,6 +398,23 @@ struct tsdb_sec_info {
 };
 typedef struct tsdb_sec_info *tsdb_sec_info_t;
 
+/* TSDB sector index, it's only saved in RAM, the sector address is the table index multiplied by sector size */
+struct tsdb_sec_index {
+    fdb_sector_store_status_t status;            /**< sector store status @see fdb_sector_store_status_t */
+    fdb_time_t start_time;                       /**< the first start node's timestamp */
+    fdb_time_t end_time;                         /**< the last end node's timestamp */
+    uint32_t end_idx;                            /**< the last end node's index */
+#ifdef FDB_TSDB_USING_AGGR_SUMMARY
+    bool aggr_ok;                                /**< the aggregate summary is valid */
+    struct fdb_tsl_aggr aggr;                    /**< the aggregate summary of all TSL in this sector */
+#endif
+#ifdef FDB_TSDB_USING_STATUS_COUNT
+    bool status_count_ok;                        /**< the TSL status count is valid */
+    uint32_t status_count[FDB_TSL_STATUS_NUM];   /**< the TSL number of each status in this sector */
+#endif
+};
+typedef struct tsdb_sec_index *tsdb_sec_index_t;
+
 struct kv_cache_node {
     uint16_t name_crc;                           /**< KV name's CRC32 low 16bit value */
     uint16_t active;                             /**< KV node access active degree */
@@ -259,6 +422,45 @@ struct kv_cache_node {
 };
 typedef struct kv_cache_node *kv_cache_node_t;
 
+struct kv_index_node {
+    uint32_t name_crc;                           /**< KV name's CRC32 value */
+    uint32_t addr;                               /**< KV node address, 0xFFFFFFFF: unused */
+};
+typedef struct kv_index_node *kv_index_node_t;
+
+struct kv_miss_cache_node {
+    uint32_t name_crc;                           /**< KV name's CRC32 value */
+    char name[FDB_KV_NAME_MAX];                  /**< KV name, it's compared when the name CRC32 is same */
+};
+typedef struct kv_miss_cache_node *kv_miss_cache_node_t;
+
+/* KVDB sector summary, it's only saved in RAM */
+struct kvdb_sec_summary {
+    uint8_t bloom[FDB_KV_BLOOM_FILTER_SIZE];     /**< bloom filter of the KV name CRC32 which is stored in the sector */
+#ifdef FDB_KV_GC_COST_BENEFIT
+    uint32_t live_size;                          /**< the total size of the live (write or prepare delete) KV */
+    uint32_t dead_size;                          /**< the total size of the deleted and error KV */
+#endif
+};
+typedef struct kvdb_sec_summary *kv_sec_summary_t;
+
+#ifdef FDB_USING_BLOCK_CACHE
+/* the block of the RAM block cache */
+struct fdb_cache_block {
+    uint32_t addr;                               /**< the block start address on the storage, 0xFFFFFFFF: unused */
+    uint32_t hash_head;                          /**< the first block index of the hash bucket which index is same as this block, 0xFFFFFFFF: empty */
+    uint32_t hash_next;                          /**< the next block index in the same hash bucket, 0xFFFFFFFF: end */
+    bool ref;                                    /**< the reference bit for CLOCK replacement */
+    uint8_t data[FDB_BLOCK_CACHE_BLOCK_SIZE];    /**< the cached data */
+};
+#endif
+
+/* the memory of the RAM block cache which is supplied by user */
+struct fdb_block_cache_mem {
+    void *buf;                                   /**< cache memory, it MUST be aligned by 4 */
+    size_t size;                                 /**< cache memory size (bytes), each block uses sizeof(struct fdb_cache_block) */
+};
+
 /* database structure */
 typedef struct fdb_db *fdb_db_t;
 struct fdb_db {
@@ -278,14 +480,31 @@ struct fdb_db {
     bool init_ok;                                /**< initialized successfully */
     bool file_mode;                              /**< is file mode, default is false */
     bool not_formatable;                         /**< is can NOT be formated mode, default is false */
-#ifdef FDB_USING_FILE_MODE
+    uint32_t generation;                         /**< it's changed when the flash data is erased, the mapped data pointer is invalid after that */
+#if defined(FDB_USING_FILE_POSIX_SINGLE_MODE)
+    int file;                                    /**< the single database file object */
+#ifdef FDB_USING_FILE_MMAP_MODE
+    uint8_t *map;                                /**< the mapped database file */
+#endif
+#elif defined(FDB_USING_FILE_MODE)
     uint32_t cur_file_sec[FDB_FILE_CACHE_TABLE_SIZE];/**< last operate sector address  */
 #if defined(FDB_USING_FILE_POSIX_MODE)
     int cur_file[FDB_FILE_CACHE_TABLE_SIZE];     /**< current file object */
+    bool cur_file_dirty[FDB_FILE_CACHE_TABLE_SIZE];/**< the file has written data which is not synced */
 #elif defined(FDB_USING_FILE_LIBC_MODE)
     FILE *cur_file[FDB_FILE_CACHE_TABLE_SIZE];   /**< current file object */
 #endif /* FDB_USING_FILE_MODE */
     uint32_t cur_sec;                            /**< current operate sector address  */
+#endif
+#ifdef FDB_USING_FILE_MODE
+    fdb_durability_t durability;                 /**< durability level, default is FDB_DURABILITY_STRICT */
+    uint32_t group_sync;                         /**< sync once every this number of status changes in group commit level */
+    uint32_t pending_sync;                       /**< the number of the deferred sync */
+#endif
+#ifdef FDB_USING_BLOCK_CACHE
+    struct fdb_cache_block *cache_blocks;        /**< the RAM block cache, the memory is supplied by user */
+    size_t cache_block_num;                      /**< the number of the cache blocks */
+    size_t cache_hand;                           /**< the CLOCK hand of the block cache */
 #endif
     void (*lock)(fdb_db_t db);                   /**< lock the database operate */
     void (*unlock)(fdb_db_t db);                 /**< unlock the database operate */
@@ -302,14 +521,53 @@ struct fdb_kvdb {
     struct fdb_kv cur_kv;
     struct kvdb_sec_info cur_sector;
     bool last_is_complete_del;
+    uint32_t gc_step_sec_addr;                   /**< the collecting sector address by GC step, 0xFFFFFFFF: none */
+    uint32_t gc_step_kv_addr;                    /**< the next KV address in the collecting sector by GC step */
 
 #ifdef FDB_KV_USING_CACHE
+#ifndef FDB_KV_USING_INDEX
     /* KV cache table */
     struct kv_cache_node kv_cache_table[FDB_KV_CACHE_TABLE_SIZE];
+#endif
     /* sector cache table, it caching the sector info which status is current using */
     struct kvdb_sec_info sector_cache_table[FDB_SECTOR_CACHE_TABLE_SIZE];
 #endif /* FDB_KV_USING_CACHE */
 
+#ifdef FDB_KV_USING_SECTOR_TABLE
+    /* sector table, the index is the sector number. It replaces the sector cache table when all sectors are loaded */
+    struct kvdb_sec_info sector_table[FDB_KV_SECTOR_TABLE_SIZE];
+    bool sector_table_ok;                        /**< all sector info has been loaded to the sector table */
+#endif /* FDB_KV_USING_SECTOR_TABLE */
+
+#ifdef FDB_KV_USING_INDEX
+    /* KV hash index table, it's indexing all KV which status is FDB_KV_WRITE */
+    struct kv_index_node kv_index_table[FDB_KV_INDEX_TABLE_SIZE];
+    uint32_t kv_index_num;                       /**< the indexed KV number */
+    bool kv_index_ok;                            /**< all KV is indexed, the KV is NOT exist when index missed */
+#endif /* FDB_KV_USING_INDEX */
+
+#ifdef FDB_KV_USING_SECTOR_SUMMARY
+    /* sector summary table, the index is the sector number */
+    struct kvdb_sec_summary sector_summary_table[FDB_KV_SECTOR_SUMMARY_TABLE_SIZE];
+    bool sector_summary_ok;                      /**< all sector summary has been built */
+#endif /* FDB_KV_USING_SECTOR_SUMMARY */
+
+#ifdef FDB_KV_USING_MISS_CACHE
+    /* KV miss cache table, it caching the name of the recently missed KV */
+    struct kv_miss_cache_node kv_miss_cache_table[FDB_KV_MISS_CACHE_TABLE_SIZE];
+    uint16_t kv_miss_cache_num;                  /**< the cached missed KV number */
+    uint16_t kv_miss_cache_next;                 /**< the next replaced node when the table is full */
+#endif /* FDB_KV_USING_MISS_CACHE */
+
+#ifdef FDB_KV_USING_WRITE_BUF
+    /* KV write buffer, the recently set KV is saved in it before flushed to flash */
+    uint8_t write_buf[FDB_KV_WRITE_BUF_SIZE];
+    size_t write_buf_used;                       /**< the used size of the write buffer */
+    fdb_time_t write_buf_time;                   /**< the time when the first KV is saved in the write buffer */
+    fdb_time_t flush_timeout;                    /**< the write buffer flush timeout, 0: disable */
+    fdb_get_time get_time;                       /**< the current timestamp get function */
+#endif /* FDB_KV_USING_WRITE_BUF */
+
 #ifdef FDB_KV_AUTO_UPDATE
     uint32_t ver_num;                            /**< setting version number for update */
 #endif
@@ -326,6 +584,13 @@ struct fdb_tsdb {
     fdb_get_time get_time;                       /**< the current timestamp get function */
     size_t max_len;                              /**< the maximum length of each log */
     bool rollover;                               /**< the oldest data will rollover by newest data, default is true */
+    fdb_tsl_get_value get_value;                 /**< the value get function of the TSL aggregate */
+
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+    /* sector index table, the index is the sector number */
+    struct tsdb_sec_index sector_index_table[FDB_TSDB_SECTOR_INDEX_TABLE_SIZE];
+    bool sector_index_ok;                        /**< all sectors are indexed */
+#endif /* FDB_TSDB_USING_SECTOR_INDEX */
 
     void *user_data;
 };
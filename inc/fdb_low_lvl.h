@@ -53,6 +53,11 @@
 /* invalid address */
 #define FDB_FAILED_ADDR                      0xFFFFFFFF
 
+/* the buffer size when scanning the flash data (KV magic word or erased data), it MUST be aligned by 4 */
+#ifndef FDB_SCAN_BUF_SIZE
+#define FDB_SCAN_BUF_SIZE                    64
+#endif
+
 size_t _fdb_set_status(uint8_t status_table[], size_t status_num, size_t status_index);
 size_t _fdb_get_status(uint8_t status_table[], size_t status_num);
 uint32_t _fdb_continue_ff_addr(fdb_db_t db, uint32_t start, uint32_t end);
@@ -63,8 +68,11 @@ const char *_fdb_db_path(fdb_db_t db);
 fdb_err_t _fdb_write_status(fdb_db_t db, uint32_t addr, uint8_t status_table[], size_t status_num, size_t status_index, bool sync);
 size_t _fdb_read_status(fdb_db_t db, uint32_t addr, uint8_t status_table[], size_t total_num);
 fdb_err_t _fdb_flash_read(fdb_db_t db, uint32_t addr, void *buf, size_t size);
+const void *_fdb_flash_map(fdb_db_t db, uint32_t addr, size_t size);
 fdb_err_t _fdb_flash_erase(fdb_db_t db, uint32_t addr, size_t size);
 fdb_err_t _fdb_flash_write(fdb_db_t db, uint32_t addr, const void *buf, size_t size, bool sync);
+fdb_err_t _fdb_flash_sync(fdb_db_t db);
+void _fdb_set_durability(fdb_db_t db, fdb_durability_t durability);
 
 fdb_err_t _fdb_flash_write_align(fdb_db_t db, uint32_t addr, const uint32_t *buf, size_t size);
 
@@ -36,6 +36,8 @@ fdb_err_t fdb_kvdb_init   (fdb_kvdb_t db, const char *name, const char *path, st
 void      fdb_kvdb_control(fdb_kvdb_t db, int cmd, void *arg);
 fdb_err_t fdb_kvdb_check(fdb_kvdb_t db);
 fdb_err_t fdb_kvdb_deinit(fdb_kvdb_t db);
+fdb_err_t fdb_kvdb_flush (fdb_kvdb_t db);
+bool      fdb_kvdb_gc_step(fdb_kvdb_t db, size_t budget);
 fdb_err_t fdb_tsdb_init   (fdb_tsdb_t db, const char *name, const char *path, fdb_get_time get_time, size_t max_len,
         void *user_data);
 void      fdb_tsdb_control(fdb_tsdb_t db, int cmd, void *arg);
@@ -44,15 +46,20 @@ fdb_err_t fdb_tsdb_deinit(fdb_tsdb_t db);
 /* blob API */
 fdb_blob_t fdb_blob_make     (fdb_blob_t blob, const void *value_buf, size_t buf_len);
 size_t     fdb_blob_read     (fdb_db_t db, fdb_blob_t blob);
+uint32_t   fdb_db_generation (fdb_db_t db);
+fdb_err_t  fdb_db_sync       (fdb_db_t db);
+fdb_err_t  fdb_db_sync_multi (fdb_db_t dbs[], size_t num);
 
 /* Key-Value API like a KV DB */
 fdb_err_t         fdb_kv_set          (fdb_kvdb_t db, const char *key, const char *value);
 char             *fdb_kv_get          (fdb_kvdb_t db, const char *key);
 fdb_err_t         fdb_kv_set_blob     (fdb_kvdb_t db, const char *key, fdb_blob_t blob);
+fdb_err_t         fdb_kv_set_batch    (fdb_kvdb_t db, const char *keys[], struct fdb_blob blobs[], size_t num);
 size_t            fdb_kv_get_blob     (fdb_kvdb_t db, const char *key, fdb_blob_t blob);
 fdb_err_t         fdb_kv_del          (fdb_kvdb_t db, const char *key);
 fdb_kv_t          fdb_kv_get_obj      (fdb_kvdb_t db, const char *key, fdb_kv_t kv);
 fdb_blob_t        fdb_kv_to_blob      (fdb_kv_t   kv, fdb_blob_t blob);
+const void       *fdb_kv_get_ptr      (fdb_kvdb_t db, const char *key, size_t *value_len, uint32_t *generation);
 fdb_err_t         fdb_kv_set_default  (fdb_kvdb_t db);
 void              fdb_kv_print        (fdb_kvdb_t db);
 fdb_kv_iterator_t fdb_kv_iterator_init(fdb_kvdb_t db, fdb_kv_iterator_t itr);
@@ -61,13 +68,21 @@ bool              fdb_kv_iterate      (fdb_kvdb_t db, fdb_kv_iterator_t itr);
 /* Time series log API like a TSDB */
 fdb_err_t  fdb_tsl_append      (fdb_tsdb_t db, fdb_blob_t blob);
 fdb_err_t  fdb_tsl_append_with_ts(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t timestamp);
+fdb_err_t  fdb_tsl_append_batch(fdb_tsdb_t db, struct fdb_blob blobs[], const fdb_time_t timestamps[], size_t num);
 void       fdb_tsl_iter        (fdb_tsdb_t db, fdb_tsl_cb cb, void *cb_arg);
 void       fdb_tsl_iter_reverse(fdb_tsdb_t db, fdb_tsl_cb cb, void *cb_arg);
 void       fdb_tsl_iter_by_time(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl_cb cb, void *cb_arg);
+fdb_tsl_cursor_t fdb_tsl_cursor_init(fdb_tsdb_t db, fdb_tsl_cursor_t cursor);
+void       fdb_tsl_cursor_seek (fdb_tsdb_t db, fdb_tsl_cursor_t cursor, fdb_time_t time);
+bool       fdb_tsl_cursor_next (fdb_tsdb_t db, fdb_tsl_cursor_t cursor);
+bool       fdb_tsl_cursor_prev (fdb_tsdb_t db, fdb_tsl_cursor_t cursor);
+fdb_err_t  fdb_tsl_aggregate   (fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl_aggr_t aggr);
 size_t     fdb_tsl_query_count (fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl_status_t status);
+size_t     fdb_tsl_query_count_all(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to);
 fdb_err_t  fdb_tsl_set_status  (fdb_tsdb_t db, fdb_tsl_t tsl, fdb_tsl_status_t status);
 void       fdb_tsl_clean       (fdb_tsdb_t db);
 fdb_blob_t fdb_tsl_to_blob     (fdb_tsl_t tsl, fdb_blob_t blob);
+const void *fdb_tsl_get_ptr     (fdb_tsdb_t db, fdb_tsl_t tsl, size_t *log_len, uint32_t *generation);
 
 /* fdb_utils.c */
 uint32_t   fdb_calc_crc32(uint32_t crc, const void *buf, size_t size);
@@ -20,10 +20,17 @@
 #if !defined(_MSC_VER)
 #include <unistd.h>
 #endif
+#ifdef FDB_USING_FILE_MMAP_MODE
+#include <sys/mman.h>
+#endif
 #endif /* FDB_USING_FILE_POSIX_MODE */
 
 #define FDB_LOG_TAG ""
 
+#ifdef FDB_USING_FILE_MODE
+extern fdb_err_t _fdb_file_sync(fdb_db_t db);
+#endif
+
 #if !defined(FDB_USING_FAL_MODE) && !defined(FDB_USING_FILE_MODE)
 #error "Please defined the FDB_USING_FAL_MODE or FDB_USING_FILE_MODE macro"
 #endif
@@ -44,15 +51,24 @@ fdb_err_t _fdb_init_ex(fdb_db_t db, const char *name, const char *path, fdb_db_t
 
     if (db->file_mode) {
 #ifdef FDB_USING_FILE_MODE
-        memset(db->cur_file_sec, FDB_FAILED_ADDR, FDB_FILE_CACHE_TABLE_SIZE * sizeof(db->cur_file_sec[0]));
         /* must set when using file mode */
         FDB_ASSERT(db->sec_size != 0);
         FDB_ASSERT(db->max_size != 0);
+        db->pending_sync = 0;
+#if defined(FDB_USING_FILE_POSIX_SINGLE_MODE)
+        db->file = -1;
+#ifdef FDB_USING_FILE_MMAP_MODE
+        db->map = NULL;
+#endif
+#else
+        memset(db->cur_file_sec, FDB_FAILED_ADDR, FDB_FILE_CACHE_TABLE_SIZE * sizeof(db->cur_file_sec[0]));
 #ifdef FDB_USING_FILE_POSIX_MODE
         memset(db->cur_file, -1, FDB_FILE_CACHE_TABLE_SIZE * sizeof(db->cur_file[0]));
+        memset(db->cur_file_dirty, 0, FDB_FILE_CACHE_TABLE_SIZE * sizeof(db->cur_file_dirty[0]));
 #else
         memset(db->cur_file, 0, FDB_FILE_CACHE_TABLE_SIZE * sizeof(db->cur_file[0]));
 #endif
+#endif /* defined(FDB_USING_FILE_POSIX_SINGLE_MODE) */
         db->storage.dir = path;
         FDB_ASSERT(strlen(path) != 0)
 #endif
@@ -96,6 +112,25 @@ fdb_err_t _fdb_init_ex(fdb_db_t db, const char *name, const char *path, fdb_db_t
         return FDB_INIT_FAILED;
     }
 
+#ifdef FDB_USING_BLOCK_CACHE
+    if (db->cache_block_num) {
+        size_t i;
+
+        /* the cache block MUST NOT cross the sector */
+        if (db->sec_size % FDB_BLOCK_CACHE_BLOCK_SIZE != 0) {
+            FDB_INFO("Warning: block cache is disabled, the sector size (%" PRIu32 ") MUST align with cache block size (%d).\n",
+                    db->sec_size, FDB_BLOCK_CACHE_BLOCK_SIZE);
+            db->cache_block_num = 0;
+        }
+        for (i = 0; i < db->cache_block_num; i++) {
+            db->cache_blocks[i].addr = FDB_FAILED_ADDR;
+            db->cache_blocks[i].hash_head = FDB_FAILED_ADDR;
+            db->cache_blocks[i].ref = false;
+        }
+        db->cache_hand = 0;
+    }
+#endif /* FDB_USING_BLOCK_CACHE */
+
     return FDB_NO_ERR;
 }
 
@@ -121,6 +156,23 @@ void _fdb_deinit(fdb_db_t db)
 
     if (db->init_ok) {
 #ifdef FDB_USING_FILE_MODE
+        /* sync the deferred writes by the relaxed durability level */
+        if (db->file_mode && db->pending_sync) {
+            _fdb_file_sync(db);
+        }
+#endif
+#if defined(FDB_USING_FILE_POSIX_SINGLE_MODE)
+#ifdef FDB_USING_FILE_MMAP_MODE
+        if (db->map) {
+            munmap(db->map, db->max_size);
+            db->map = NULL;
+        }
+#endif
+        if (db->file >= 0) {
+            close(db->file);
+            db->file = -1;
+        }
+#elif defined(FDB_USING_FILE_MODE)
         for (int i = 0; i < FDB_FILE_CACHE_TABLE_SIZE; i++) {
 #ifdef FDB_USING_FILE_POSIX_MODE
             if (db->cur_file[i] > 0) {
@@ -136,6 +188,7 @@ void _fdb_deinit(fdb_db_t db)
     }
 
     db->init_ok = false;
+    db->generation++;
 }
 
 const char *_fdb_db_path(fdb_db_t db)
@@ -16,16 +16,30 @@
 
 #define DB_PATH_MAX            256
 
+#define ERASED_DATA_X4         FDB_BYTE_ERASED, FDB_BYTE_ERASED, FDB_BYTE_ERASED, FDB_BYTE_ERASED
+#define ERASED_DATA_X16        ERASED_DATA_X4, ERASED_DATA_X4, ERASED_DATA_X4, ERASED_DATA_X4
+#define ERASED_DATA_X64        ERASED_DATA_X16, ERASED_DATA_X16, ERASED_DATA_X16, ERASED_DATA_X16
+#define ERASED_DATA_X256       ERASED_DATA_X64, ERASED_DATA_X64, ERASED_DATA_X64, ERASED_DATA_X64
+#define ERASED_DATA_X1024      ERASED_DATA_X256, ERASED_DATA_X256, ERASED_DATA_X256, ERASED_DATA_X256
+/* the erased data which is filled to the database file, a 4096 bytes sector is filled by one write */
+static const uint8_t erased_data[] = { ERASED_DATA_X1024, ERASED_DATA_X1024, ERASED_DATA_X1024, ERASED_DATA_X1024 };
+#define FILL_BUF_SIZE          sizeof(erased_data)
+
 static void get_db_file_path(fdb_db_t db, uint32_t addr, char *path, size_t size)
 {
 #define DB_NAME_MAX            8
 
-    /* from db_name.fdb.0 to db_name.fdb.n */
     char file_name[DB_NAME_MAX + 4 + 10];
+#ifdef FDB_USING_FILE_POSIX_SINGLE_MODE
+    /* all sectors are saved in db_name.fdb */
+    snprintf(file_name, sizeof(file_name), "%.*s.fdb", DB_NAME_MAX, db->name);
+#else
+    /* from db_name.fdb.0 to db_name.fdb.n */
     uint32_t sec_addr = FDB_ALIGN_DOWN(addr, db->sec_size);
     int index = sec_addr / db->sec_size;
 
     snprintf(file_name, sizeof(file_name), "%.*s.fdb.%d", DB_NAME_MAX, db->name, index);
+#endif
     if (strlen(db->storage.dir) + 1 + strlen(file_name) >= size) {
         /* path is too long */
         FDB_INFO("Error: db (%s) file path (%s) is too log.\n", file_name, db->storage.dir);
@@ -35,6 +49,215 @@ static void get_db_file_path(fdb_db_t db, uint32_t addr, char *path, size_t size
 }
 
 #if defined(FDB_USING_FILE_POSIX_MODE)
+#if !defined(_MSC_VER)
+#include <unistd.h>
+#endif
+/* only the file data and the metadata for reading it (file size) are synced when fdatasync is supported */
+#if defined(_POSIX_SYNCHRONIZED_IO) && (_POSIX_SYNCHRONIZED_IO > 0)
+#define sync_file(fd)          fdatasync(fd)
+#else
+#define sync_file(fd)          fsync(fd)
+#endif
+#endif /* defined(FDB_USING_FILE_POSIX_MODE) */
+
+#if defined(FDB_USING_FILE_POSIX_SINGLE_MODE)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef FDB_USING_FILE_MMAP_MODE
+#include <sys/mman.h>
+#endif
+
+static fdb_err_t fill_erased_data(int fd, uint32_t offset, size_t size)
+{
+    size_t len;
+
+    for (; size > 0; offset += len, size -= len) {
+        len = size < FILL_BUF_SIZE ? size : FILL_BUF_SIZE;
+        if (pwrite(fd, erased_data, len, offset) != (ssize_t)len) {
+            return FDB_ERASE_ERR;
+        }
+    }
+
+    return FDB_NO_ERR;
+}
+
+/*
+ * Open the database file on the first access. The whole database is saved in one file,
+ * so the file is preallocated to the database max size with erased data.
+ */
+static int open_db_file(fdb_db_t db)
+{
+    char path[DB_PATH_MAX];
+    struct stat file_stat;
+
+    if (db->file >= 0) {
+        return db->file;
+    }
+
+    get_db_file_path(db, 0, path, DB_PATH_MAX);
+    db->file = open(path, O_RDWR | O_CREAT, 0777);
+    if (db->file < 0) {
+        FDB_INFO("Error: open (%s) file failed.\n", path);
+        return -1;
+    }
+    if (fstat(db->file, &file_stat) == 0 && file_stat.st_size < (off_t)db->max_size) {
+        if (fill_erased_data(db->file, file_stat.st_size, db->max_size - file_stat.st_size) != FDB_NO_ERR) {
+            FDB_INFO("Error: preallocate (%s) file failed.\n", path);
+            close(db->file);
+            db->file = -1;
+            return -1;
+        }
+        sync_file(db->file);
+    }
+#ifdef FDB_USING_FILE_MMAP_MODE
+    db->map = mmap(NULL, db->max_size, PROT_READ | PROT_WRITE, MAP_SHARED, db->file, 0);
+    if (db->map == MAP_FAILED) {
+        FDB_INFO("Error: map (%s) file failed.\n", path);
+        db->map = NULL;
+        close(db->file);
+        db->file = -1;
+        return -1;
+    }
+#endif
+
+    return db->file;
+}
+
+#ifdef FDB_USING_FILE_MMAP_MODE
+/* the written data will be synced by msync, all dirty pages of the mapping are synced like fsync */
+static void sync_db_file(fdb_db_t db)
+{
+    msync(db->map, db->max_size, MS_SYNC);
+}
+
+fdb_err_t _fdb_file_sync(fdb_db_t db)
+{
+    if (db->map && msync(db->map, db->max_size, MS_SYNC) != 0) {
+        return FDB_WRITE_ERR;
+    }
+
+    return FDB_NO_ERR;
+}
+
+const void *_fdb_file_map(fdb_db_t db, uint32_t addr, size_t size)
+{
+    if (open_db_file(db) < 0 || addr > db->max_size || size > db->max_size - addr) {
+        return NULL;
+    }
+
+    return db->map + addr;
+}
+
+fdb_err_t _fdb_file_read(fdb_db_t db, uint32_t addr, void *buf, size_t size)
+{
+    const void *data = _fdb_file_map(db, addr, size);
+
+    if (data == NULL) {
+        return FDB_READ_ERR;
+    }
+    memcpy(buf, data, size);
+
+    return FDB_NO_ERR;
+}
+
+fdb_err_t _fdb_file_write(fdb_db_t db, uint32_t addr, const void *buf, size_t size, bool sync)
+{
+    if (_fdb_file_map(db, addr, size) == NULL) {
+        return FDB_WRITE_ERR;
+    }
+    memcpy(db->map + addr, buf, size);
+    if (sync) {
+        sync_db_file(db);
+    }
+
+    return FDB_NO_ERR;
+}
+
+fdb_err_t _fdb_file_erase(fdb_db_t db, uint32_t addr, size_t size)
+{
+    if (_fdb_file_map(db, addr, size) == NULL) {
+        return FDB_ERASE_ERR;
+    }
+    memset(db->map + addr, FDB_BYTE_ERASED, size);
+    sync_db_file(db);
+
+    return FDB_NO_ERR;
+}
+#else
+
+fdb_err_t _fdb_file_read(fdb_db_t db, uint32_t addr, void *buf, size_t size)
+{
+    int fd = open_db_file(db);
+
+    if (fd < 0 || pread(fd, buf, size, addr) != (ssize_t)size) {
+        return FDB_READ_ERR;
+    }
+
+    return FDB_NO_ERR;
+}
+
+fdb_err_t _fdb_file_write(fdb_db_t db, uint32_t addr, const void *buf, size_t size, bool sync)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    int fd = open_db_file(db);
+
+    if (fd >= 0) {
+        if (pwrite(fd, buf, size, addr) != (ssize_t)size)
+            result = FDB_WRITE_ERR;
+        if (sync) {
+            sync_file(fd);
+        }
+    } else {
+        result = FDB_WRITE_ERR;
+    }
+    return result;
+}
+
+fdb_err_t _fdb_file_sync(fdb_db_t db)
+{
+    if (db->file >= 0 && sync_file(db->file) != 0) {
+        return FDB_WRITE_ERR;
+    }
+
+    return FDB_NO_ERR;
+}
+
+#ifdef FDB_USING_FILE_IO_URING
+/* duplicate the database file, so it can be synced after the database is unlocked */
+static size_t dup_unsynced_files(fdb_db_t db, int fds[], fdb_err_t *result)
+{
+    if (db->file < 0) {
+        return 0;
+    }
+    if ((fds[0] = dup(db->file)) < 0) {
+        /* sync it directly when it can't be duplicated */
+        if (sync_file(db->file) != 0) {
+            *result = FDB_WRITE_ERR;
+        }
+        return 0;
+    }
+
+    return 1;
+}
+#endif /* FDB_USING_FILE_IO_URING */
+
+fdb_err_t _fdb_file_erase(fdb_db_t db, uint32_t addr, size_t size)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    int fd = open_db_file(db);
+
+    if (fd >= 0) {
+        result = fill_erased_data(fd, addr, size);
+        sync_file(fd);
+    } else {
+        result = FDB_ERASE_ERR;
+    }
+    return result;
+}
+#endif /* FDB_USING_FILE_MMAP_MODE */
+#elif defined(FDB_USING_FILE_POSIX_MODE)
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -42,16 +265,33 @@ static void get_db_file_path(fdb_db_t db, uint32_t addr, char *path, size_t size
 #include <unistd.h>
 #endif
 
-static int get_file_from_cache(fdb_db_t db, uint32_t sec_addr)
+static int get_file_cache_index(fdb_db_t db, uint32_t sec_addr)
 {
     for (int i = 0; i < FDB_FILE_CACHE_TABLE_SIZE; i++) {
         if (db->cur_file_sec[i] == sec_addr)
-            return db->cur_file[i];
+            return i;
     }
 
     return -1;
 }
 
+static int get_file_from_cache(fdb_db_t db, uint32_t sec_addr)
+{
+    int index = get_file_cache_index(db, sec_addr);
+
+    return index < 0 ? -1 : db->cur_file[index];
+}
+
+/* the deferred writes of the file can't be synced by _fdb_file_sync after closing, so sync it before closing */
+static void close_cached_file(fdb_db_t db, int index)
+{
+    if (db->cur_file_dirty[index]) {
+        sync_file(db->cur_file[index]);
+        db->cur_file_dirty[index] = false;
+    }
+    close(db->cur_file[index]);
+}
+
 static void update_file_cache(fdb_db_t db, uint32_t sec_addr, int fd)
 {
     int free_index = FDB_FILE_CACHE_TABLE_SIZE;
@@ -59,6 +299,7 @@ static void update_file_cache(fdb_db_t db, uint32_t sec_addr, int fd)
     for (int i = 0; i < FDB_FILE_CACHE_TABLE_SIZE; i++) {
         if (db->cur_file_sec[i] == sec_addr) {
             db->cur_file[i] = fd;
+            db->cur_file_dirty[i] = false;
             return;
         } else if (db->cur_file[i] == -1) {
             free_index = i;
@@ -69,16 +310,19 @@ static void update_file_cache(fdb_db_t db, uint32_t sec_addr, int fd)
         if (free_index < FDB_FILE_CACHE_TABLE_SIZE) {
                 db->cur_file[free_index] = fd;
                 db->cur_file_sec[free_index] = sec_addr;
+                db->cur_file_dirty[free_index] = false;
         } else {
-            /* cache is full, move to end */
+            /* cache is full, close the last file and move others to end */
+            close_cached_file(db, FDB_FILE_CACHE_TABLE_SIZE - 1);
             for (int i = FDB_FILE_CACHE_TABLE_SIZE - 1; i > 0; i--) {
-                close(db->cur_file[i]);
                 memcpy(&db->cur_file[i], &db->cur_file[i - 1], sizeof(db->cur_file[0]));
                 memcpy(&db->cur_file_sec[i], &db->cur_file_sec[i - 1], sizeof(db->cur_file_sec[0]));
+                memcpy(&db->cur_file_dirty[i], &db->cur_file_dirty[i - 1], sizeof(db->cur_file_dirty[0]));
             }
             /* add to head */
             db->cur_file[0] = fd;
             db->cur_file_sec[0] = sec_addr;
+            db->cur_file_dirty[0] = false;
         }
     }
 }
@@ -93,7 +337,7 @@ static int open_db_file(fdb_db_t db, uint32_t addr, bool clean)
         get_db_file_path(db, addr, path, DB_PATH_MAX);
 
         if (fd > 0) {
-            close(fd);
+            close_cached_file(db, get_file_cache_index(db, sec_addr));
             fd = -1;
             update_file_cache(db, sec_addr, fd);
         }
@@ -119,58 +363,119 @@ static int open_db_file(fdb_db_t db, uint32_t addr, bool clean)
     return fd;
 }
 
+/*
+ * The erased data is NOT saved in the sector file. The sector file is truncated when erasing,
+ * and the data after the end of file is treated as erased data.
+ */
 fdb_err_t _fdb_file_read(fdb_db_t db, uint32_t addr, void *buf, size_t size)
 {
     fdb_err_t result = FDB_NO_ERR;
     int fd = open_db_file(db, addr, false);
+    ssize_t read_len;
     if (fd > 0) {
         /* get the offset address is relative to the start of the current file */
         addr = addr % db->sec_size;
 
-        if ((lseek(fd, addr, SEEK_SET) != (int32_t)addr) || (read(fd, buf, size) != (ssize_t)size))
+        if ((lseek(fd, addr, SEEK_SET) != (int32_t)addr) || ((read_len = read(fd, buf, size)) < 0)) {
             result = FDB_READ_ERR;
+        } else if ((size_t)read_len < size) {
+            /* the data after the end of file is erased */
+            memset((uint8_t *)buf + read_len, FDB_BYTE_ERASED, size - read_len);
+        }
     } else {
         result = FDB_READ_ERR;
     }
     return result;
 }
 
+/* fill the erased data from the end of file to the write address */
+static bool extend_erased_data(int fd, uint32_t addr)
+{
+    off_t file_size = lseek(fd, 0, SEEK_END);
+    size_t len, remain;
+
+    if (file_size < 0) {
+        return false;
+    }
+    for (; (off_t)addr > file_size; file_size += len) {
+        remain = (size_t)((off_t)addr - file_size);
+        len = remain < FILL_BUF_SIZE ? remain : FILL_BUF_SIZE;
+        if (write(fd, erased_data, len) != (ssize_t)len) {
+            return false;
+        }
+    }
+    /* the file offset is the write address now when the data is appended */
+    return (off_t)addr == file_size || lseek(fd, addr, SEEK_SET) == (off_t)addr;
+}
+
 fdb_err_t _fdb_file_write(fdb_db_t db, uint32_t addr, const void *buf, size_t size, bool sync)
 {
     fdb_err_t result = FDB_NO_ERR;
     int fd = open_db_file(db, addr, false);
     if (fd > 0) {
+        int index = get_file_cache_index(db, FDB_ALIGN_DOWN(addr, db->sec_size));
         /* get the offset address is relative to the start of the current file */
         addr = addr % db->sec_size;
 
-        if ((lseek(fd, addr, SEEK_SET) != (int32_t)addr) || (write(fd, buf, size) != (ssize_t)size))
+        if (!extend_erased_data(fd, addr) || (write(fd, buf, size) != (ssize_t)size))
             result = FDB_WRITE_ERR;
         if(sync) {
-            fsync(fd);
+            sync_file(fd);
         }
+        /* the file will be synced by _fdb_file_sync or before it's closed */
+        db->cur_file_dirty[index] = !sync;
     } else {
         result = FDB_WRITE_ERR;
     }
     return result;
 }
 
+/* sync all opened sector files which have unsynced data, the closed files are already synced before closing */
+fdb_err_t _fdb_file_sync(fdb_db_t db)
+{
+    fdb_err_t result = FDB_NO_ERR;
+
+    for (int i = 0; i < FDB_FILE_CACHE_TABLE_SIZE; i++) {
+        if (db->cur_file[i] > 0 && db->cur_file_dirty[i]) {
+            if (sync_file(db->cur_file[i]) != 0) {
+                result = FDB_WRITE_ERR;
+            }
+            db->cur_file_dirty[i] = false;
+        }
+    }
+
+    return result;
+}
+
+#ifdef FDB_USING_FILE_IO_URING
+/* duplicate the sector files which have unsynced data, so they can be synced after the database is unlocked */
+static size_t dup_unsynced_files(fdb_db_t db, int fds[], fdb_err_t *result)
+{
+    size_t num = 0;
+
+    for (int i = 0; i < FDB_FILE_CACHE_TABLE_SIZE; i++) {
+        if (db->cur_file[i] > 0 && db->cur_file_dirty[i]) {
+            if ((fds[num] = dup(db->cur_file[i])) >= 0) {
+                num++;
+            } else if (sync_file(db->cur_file[i]) != 0) {
+                /* sync it directly when it can't be duplicated */
+                *result = FDB_WRITE_ERR;
+            }
+            db->cur_file_dirty[i] = false;
+        }
+    }
+
+    return num;
+}
+#endif /* FDB_USING_FILE_IO_URING */
+
 fdb_err_t _fdb_file_erase(fdb_db_t db, uint32_t addr, size_t size)
 {
     fdb_err_t result = FDB_NO_ERR;
+    /* the sector file is truncated to empty, so the whole sector is erased */
     int fd = open_db_file(db, addr, true);
     if (fd > 0) {
-#define BUF_SIZE 32
-        uint8_t buf[BUF_SIZE];
-        size_t i;
-        lseek(fd, 0, SEEK_SET);
-        for (i = 0; i * BUF_SIZE < size; i++)
-        {
-            memset(buf, 0xFF, BUF_SIZE);
-            write(fd, buf, BUF_SIZE);
-        }
-        memset(buf, 0xFF, BUF_SIZE);
-        write(fd, buf, size - i * BUF_SIZE);
-        fsync(fd);
+        sync_file(fd);
     } else {
         result = FDB_ERASE_ERR;
     }
@@ -208,9 +513,9 @@ static void update_file_cache(fdb_db_t db, uint32_t sec_addr, FILE *fd)
             db->cur_file_sec[free_index] = sec_addr;
         }
         else {
-            /* cache is full, move to end */
+            /* cache is full, close the last file and move others to end. The buffered data is flushed by fclose. */
+            fclose(db->cur_file[FDB_FILE_CACHE_TABLE_SIZE - 1]);
             for (int i = FDB_FILE_CACHE_TABLE_SIZE - 1; i > 0; i--) {
-                fclose(db->cur_file[i]);
                 memcpy(&db->cur_file[i], &db->cur_file[i - 1], sizeof(db->cur_file[0]));
                 memcpy(&db->cur_file_sec[i], &db->cur_file_sec[i - 1], sizeof(db->cur_file_sec[0]));
             }
@@ -257,27 +562,61 @@ static FILE *open_db_file(fdb_db_t db, uint32_t addr, bool clean)
     return fd;
 }
 
+/*
+ * The erased data is NOT saved in the sector file. The sector file is truncated when erasing,
+ * and the data after the end of file is treated as erased data.
+ */
 fdb_err_t _fdb_file_read(fdb_db_t db, uint32_t addr, void *buf, size_t size)
 {
     fdb_err_t result = FDB_NO_ERR;
     FILE *fp = open_db_file(db, addr, false);
+    size_t read_len;
     if (fp) {
         addr = addr % db->sec_size;
-        if ((fseek(fp, addr, SEEK_SET) != 0) || (fread(buf, size, 1, fp) != 1))
+        if (fseek(fp, addr, SEEK_SET) != 0) {
             result = FDB_READ_ERR;
+        } else if ((read_len = fread(buf, 1, size, fp)) < size) {
+            if (ferror(fp)) {
+                clearerr(fp);
+                result = FDB_READ_ERR;
+            } else {
+                /* the data after the end of file is erased */
+                memset((uint8_t *)buf + read_len, FDB_BYTE_ERASED, size - read_len);
+            }
+        }
     } else {
         result = FDB_READ_ERR;
     }
     return result;
 }
 
+/* fill the erased data from the end of file to the write address */
+static bool extend_erased_data(FILE *fp, uint32_t addr)
+{
+    long file_size;
+    size_t len, remain;
+
+    if (fseek(fp, 0, SEEK_END) != 0 || (file_size = ftell(fp)) < 0) {
+        return false;
+    }
+    for (; (long)addr > file_size; file_size += len) {
+        remain = (size_t)((long)addr - file_size);
+        len = remain < FILL_BUF_SIZE ? remain : FILL_BUF_SIZE;
+        if (fwrite(erased_data, len, 1, fp) != 1) {
+            return false;
+        }
+    }
+
+    return fseek(fp, addr, SEEK_SET) == 0;
+}
+
 fdb_err_t _fdb_file_write(fdb_db_t db, uint32_t addr, const void *buf, size_t size, bool sync)
 {
     fdb_err_t result = FDB_NO_ERR;
     FILE *fp = open_db_file(db, addr, false);
     if (fp) {
         addr = addr % db->sec_size;
-        if ((fseek(fp, addr, SEEK_SET) != 0) || (fwrite(buf, size, 1, fp) != 1))
+        if (!extend_erased_data(fp, addr) || (fwrite(buf, size, 1, fp) != 1))
             result = FDB_READ_ERR;
         if(sync) {
             fflush(fp);
@@ -288,23 +627,26 @@ fdb_err_t _fdb_file_write(fdb_db_t db, uint32_t addr, const void *buf, size_t si
     return result;
 }
 
-fdb_err_t _fdb_file_erase(fdb_db_t db, uint32_t addr, size_t size)
+/* flush all opened sector files */
+fdb_err_t _fdb_file_sync(fdb_db_t db)
 {
     fdb_err_t result = FDB_NO_ERR;
 
+    for (int i = 0; i < FDB_FILE_CACHE_TABLE_SIZE; i++) {
+        if (db->cur_file[i] && fflush(db->cur_file[i]) != 0) {
+            result = FDB_WRITE_ERR;
+        }
+    }
+
+    return result;
+}
+
+fdb_err_t _fdb_file_erase(fdb_db_t db, uint32_t addr, size_t size)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    /* the sector file is truncated to empty, so the whole sector is erased */
     FILE *fp = open_db_file(db, addr, true);
     if (fp != NULL) {
-#define BUF_SIZE 32
-        uint8_t buf[BUF_SIZE];
-        size_t i;
-        fseek(fp, 0, SEEK_SET);
-        for (i = 0; i * BUF_SIZE < size; i++)
-        {
-            memset(buf, 0xFF, BUF_SIZE);
-            fwrite(buf, BUF_SIZE, 1, fp);
-        }
-        memset(buf, 0xFF, BUF_SIZE);
-        fwrite(buf, size - i * BUF_SIZE, 1, fp);
         fflush(fp);
     } else {
         result = FDB_ERASE_ERR;
@@ -313,5 +655,193 @@ fdb_err_t _fdb_file_erase(fdb_db_t db, uint32_t addr, size_t size)
 }
 #endif /* defined(FDB_USING_FILE_LIBC_MODE) */
 
+#ifdef FDB_USING_FILE_IO_URING
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+/* the io_uring which only submits the fsync, the SQ and CQ ring are mapped by one mmap (IORING_FEAT_SINGLE_MMAP) */
+struct sync_ring {
+    int fd;
+    void *ring;
+    size_t ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+};
+
+static void sync_ring_deinit(struct sync_ring *ring)
+{
+    if (ring->fd < 0) {
+        return;
+    }
+    if (ring->ring != MAP_FAILED) {
+        munmap(ring->ring, ring->ring_size);
+    }
+    if (ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    close(ring->fd);
+    ring->fd = -1;
+}
+
+static bool sync_ring_init(struct sync_ring *ring, unsigned entries)
+{
+    struct io_uring_params params;
+    uint8_t *ptr;
+
+    memset(&params, 0, sizeof(params));
+    ring->ring = MAP_FAILED;
+    ring->sqes = MAP_FAILED;
+    /* the io_uring maybe not supported by the kernel or disabled by the system */
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        sync_ring_deinit(ring);
+        return false;
+    }
+    ring->ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    if (ring->ring_size < params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe)) {
+        ring->ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->ring = mmap(NULL, ring->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+            IORING_OFF_SQ_RING);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+            IORING_OFF_SQES);
+    if (ring->ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        sync_ring_deinit(ring);
+        return false;
+    }
+    ptr = ring->ring;
+    ring->sq_tail = (unsigned *)(ptr + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(ptr + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(ptr + params.sq_off.array);
+    ring->cq_head = (unsigned *)(ptr + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(ptr + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(ptr + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(ptr + params.cq_off.cqes);
+
+    return true;
+}
+
+/*
+ * Submit the fsync of all files at once, then wait all completions. The failed sync of the file is set to result.
+ *
+ * @return false: the io_uring is broken, the files are NOT all synced
+ */
+static bool sync_ring_submit(struct sync_ring *ring, const int fds[], size_t num, fdb_err_t *result)
+{
+    unsigned tail = *ring->sq_tail, head, index;
+    size_t submitted = 0, done = 0, i;
+    int ret;
+
+    for (i = 0; i < num; i++, tail++) {
+        index = tail & *ring->sq_mask;
+        memset(&ring->sqes[index], 0, sizeof(struct io_uring_sqe));
+        ring->sqes[index].opcode = IORING_OP_FSYNC;
+        ring->sqes[index].fd = fds[i];
+        /* same as the fdatasync */
+        ring->sqes[index].fsync_flags = IORING_FSYNC_DATASYNC;
+        ring->sq_array[index] = index;
+    }
+    /* the SQEs MUST be filled before the kernel sees the new tail */
+    __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+    while (done < num) {
+        ret = (int)syscall(__NR_io_uring_enter, ring->fd, (unsigned)(num - submitted), 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        submitted += ret;
+        /* reap all completed CQEs */
+        head = *ring->cq_head;
+        while (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+            if (ring->cqes[head & *ring->cq_mask].res < 0) {
+                *result = FDB_WRITE_ERR;
+            }
+            head++;
+            done++;
+        }
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    return true;
+}
+
+/* sync the duplicated files by io_uring, or one by one when the io_uring is not available, then close them */
+static fdb_err_t sync_dup_files(struct sync_ring *ring, int fds[], size_t num)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    size_t i;
+
+    if (ring->fd >= 0 && !sync_ring_submit(ring, fds, num, &result)) {
+        /* the files in the broken io_uring maybe not synced, so don't use it any more */
+        sync_ring_deinit(ring);
+    }
+    for (i = 0; i < num; i++) {
+        if (ring->fd < 0 && sync_file(fds[i]) != 0) {
+            result = FDB_WRITE_ERR;
+        }
+        close(fds[i]);
+    }
+
+    return result;
+}
+
+/*
+ * Sync the files of all databases concurrently. The unsynced files of each database are duplicated under its lock,
+ * then they are synced by one io_uring submission without holding any database lock.
+ */
+fdb_err_t _fdb_file_sync_multi(fdb_db_t dbs[], size_t num)
+{
+    int fds[FDB_FILE_IO_URING_ENTRIES];
+    size_t fd_num = 0, i;
+    struct sync_ring ring;
+    fdb_err_t result = FDB_NO_ERR;
+
+    sync_ring_init(&ring, FDB_FILE_IO_URING_ENTRIES);
+    for (i = 0; i < num; i++) {
+        if (!dbs[i]->file_mode) {
+            /* the flash data in FAL mode is always synced */
+            continue;
+        }
+        if (fd_num + FDB_FILE_CACHE_TABLE_SIZE > FDB_FILE_IO_URING_ENTRIES) {
+            /* the queue is full, sync the collected files first */
+            if (sync_dup_files(&ring, fds, fd_num) != FDB_NO_ERR) {
+                result = FDB_WRITE_ERR;
+            }
+            fd_num = 0;
+        }
+        if (dbs[i]->lock) {
+            dbs[i]->lock(dbs[i]);
+        }
+        fd_num += dup_unsynced_files(dbs[i], fds + fd_num, &result);
+        dbs[i]->pending_sync = 0;
+        if (dbs[i]->unlock) {
+            dbs[i]->unlock(dbs[i]);
+        }
+    }
+    if (sync_dup_files(&ring, fds, fd_num) != FDB_NO_ERR) {
+        result = FDB_WRITE_ERR;
+    }
+    sync_ring_deinit(&ring);
+
+    return result;
+}
+#endif /* FDB_USING_FILE_IO_URING */
+
 #endif /* FDB_USING_FILE_MODE */
 
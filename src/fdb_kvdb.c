@@ -48,15 +48,49 @@
 #define FDB_GC_EMPTY_SEC_THRESHOLD                1
 #endif
 
+/* the buffer size when moving the KV to new space, it MUST be aligned by 4 and the write granularity */
+#ifndef FDB_KV_MOVE_BUF_SIZE
+#define FDB_KV_MOVE_BUF_SIZE                     32
+#endif
+
+/* the staging buffer size when writing the KV header, name and value, it MUST be aligned by 4 and the write granularity */
+#ifndef FDB_KV_STAGE_BUF_SIZE
+#define FDB_KV_STAGE_BUF_SIZE                    64
+#endif
+
 /* the string KV value buffer size for legacy fdb_get_kv(db, ) function */
 #ifndef FDB_STR_KV_VALUE_MAX_SIZE
 #define FDB_STR_KV_VALUE_MAX_SIZE                128
 #endif
 
+#if (FDB_KV_MOVE_BUF_SIZE % 4 != 0) || (FDB_KV_MOVE_BUF_SIZE % ((FDB_WRITE_GRAN + 7) / 8) != 0)
+#error "The KV move buffer size must be aligned by 4 and the write granularity"
+#endif
+
+#if (FDB_KV_STAGE_BUF_SIZE % 4 != 0) || (FDB_KV_STAGE_BUF_SIZE % ((FDB_WRITE_GRAN + 7) / 8) != 0)
+#error "The KV stage buffer size must be aligned by 4 and the write granularity"
+#endif
+
 #if FDB_KV_CACHE_TABLE_SIZE > 0xFFFF
 #error "The KV cache table size must less than 0xFFFF"
 #endif
 
+#if FDB_KV_MISS_CACHE_TABLE_SIZE > 0xFFFF
+#error "The KV miss cache table size must less than 0xFFFF"
+#endif
+
+#if (FDB_KV_INDEX_TABLE_SIZE & (FDB_KV_INDEX_TABLE_SIZE - 1)) != 0
+#error "The KV index table size must be the Nth power of 2"
+#endif
+
+#if defined(FDB_KV_USING_SECTOR_TABLE) && !defined(FDB_KV_USING_CACHE)
+#error "The KV sector table needs the KV cache, please configure the FDB_KV_CACHE_TABLE_SIZE and FDB_SECTOR_CACHE_TABLE_SIZE"
+#endif
+
+#if defined(FDB_KV_GC_COST_BENEFIT) && !defined(FDB_KV_USING_SECTOR_SUMMARY)
+#error "The KV GC cost-benefit policy needs the sector summary, please configure the FDB_KV_SECTOR_SUMMARY_TABLE_SIZE"
+#endif
+
 /* the sector is not combined value */
 #if (FDB_BYTE_ERASED  == 0xFF)
 #define SECTOR_NOT_COMBINED                      0xFFFFFFFF
@@ -98,6 +132,8 @@
     } while(0);
 
 #define VER_NUM_KV_NAME                         "__ver_num__"
+/* the commit KV of the KV batch, the value is the batch KVs address range: [start, end) */
+#define BATCH_KV_NAME                           "__batch__"
 
 struct sector_hdr_data {
     struct {
@@ -146,12 +182,24 @@ struct gc_cb_args {
 
 static void gc_collect(fdb_kvdb_t db);
 static void gc_collect_by_free_size(fdb_kvdb_t db, size_t free_size);
+#ifdef FDB_KV_USING_WRITE_BUF
+static fdb_err_t flush_write_buf(fdb_kvdb_t db, const char *key);
+static fdb_err_t set_kv_to_write_buf(fdb_kvdb_t db, const char *key, const void *value_buf, size_t buf_len);
+static void check_write_buf_timeout(fdb_kvdb_t db);
+#endif
 
 #ifdef FDB_KV_USING_CACHE
 static void update_sector_cache(fdb_kvdb_t db, kv_sec_info_t sector)
 {
     size_t i, empty_index = FDB_SECTOR_CACHE_TABLE_SIZE;
 
+#ifdef FDB_KV_USING_SECTOR_TABLE
+    if (db->sector_table_ok) {
+        memcpy(&db->sector_table[sector->addr / db_sec_size(db)], sector, sizeof(struct kvdb_sec_info));
+        return;
+    }
+#endif
+
     for (i = 0; i < FDB_SECTOR_CACHE_TABLE_SIZE; i++) {
         /* update the sector empty_addr in cache */
         if (db->sector_cache_table[i].addr == sector->addr) {
@@ -178,6 +226,12 @@ static kv_sec_info_t get_sector_from_cache(fdb_kvdb_t db, uint32_t sec_addr)
 {
     size_t i;
 
+#ifdef FDB_KV_USING_SECTOR_TABLE
+    if (db->sector_table_ok) {
+        return &db->sector_table[sec_addr / db_sec_size(db)];
+    }
+#endif
+
     for (i = 0; i < FDB_SECTOR_CACHE_TABLE_SIZE; i++) {
         if (db->sector_cache_table[i].addr == sec_addr) {
             return &db->sector_cache_table[i];
@@ -204,6 +258,7 @@ static void update_sector_status_store_cache(fdb_kvdb_t db, uint32_t sec_addr, f
     }
 }
 
+#ifndef FDB_KV_USING_INDEX
 static void update_kv_cache(fdb_kvdb_t db, const char *name, size_t name_len, uint32_t addr)
 {
     size_t i, empty_index = FDB_KV_CACHE_TABLE_SIZE, min_activity_index = FDB_KV_CACHE_TABLE_SIZE;
@@ -272,16 +327,343 @@ static bool get_kv_from_cache(fdb_kvdb_t db, const char *name, size_t name_len,
 
     return false;
 }
+#endif /* FDB_KV_USING_INDEX */
 #endif /* FDB_KV_USING_CACHE */
 
+#ifdef FDB_KV_USING_INDEX
+#define KV_INDEX_MASK                            (FDB_KV_INDEX_TABLE_SIZE - 1)
+
+static void clean_kv_index(fdb_kvdb_t db)
+{
+    size_t i;
+
+    for (i = 0; i < FDB_KV_INDEX_TABLE_SIZE; i++) {
+        db->kv_index_table[i].addr = FDB_DATA_UNUSED;
+    }
+    db->kv_index_num = 0;
+    db->kv_index_ok = true;
+}
+
+/*
+ * Check the KV name on the flash is same as the name. It's return true when the name is matched.
+ */
+static bool kv_index_name_match(fdb_kvdb_t db, uint32_t addr, const char *name, size_t name_len)
+{
+    struct kv_hdr_data kv_hdr;
+    char saved_name[FDB_WG_ALIGN(FDB_KV_NAME_MAX)];
+
+    /* check the name length first, so the name will NOT be read when length is different */
+    if (_fdb_flash_read((fdb_db_t)db, addr, (uint32_t *) &kv_hdr, sizeof(struct kv_hdr_data)) != FDB_NO_ERR
+            || kv_hdr.name_len != name_len || name_len > FDB_KV_NAME_MAX) {
+        return false;
+    }
+    if (_fdb_flash_read((fdb_db_t)db, addr + KV_HDR_DATA_SIZE, (uint32_t *) saved_name, FDB_WG_ALIGN(name_len)) != FDB_NO_ERR) {
+        return false;
+    }
+
+    return !strncmp(name, saved_name, name_len);
+}
+
+/*
+ * Add or update the KV address in index. It's using open addressing (linear probing) hash table.
+ */
+static void update_kv_index(fdb_kvdb_t db, const char *name, size_t name_len, uint32_t addr)
+{
+    uint32_t name_crc = fdb_calc_crc32(0, name, name_len);
+    size_t i, probe;
+
+    for (i = name_crc & KV_INDEX_MASK, probe = 0; probe < FDB_KV_INDEX_TABLE_SIZE; i = (i + 1) & KV_INDEX_MASK, probe++) {
+        if (db->kv_index_table[i].addr == FDB_DATA_UNUSED) {
+            break;
+        } else if (db->kv_index_table[i].name_crc == name_crc
+                && kv_index_name_match(db, db->kv_index_table[i].addr, name, name_len)) {
+            /* update the KV address */
+            db->kv_index_table[i].addr = addr;
+            return;
+        }
+    }
+    /* keep at least one empty node, the probing will stop on it */
+    if (db->kv_index_num + 1 >= FDB_KV_INDEX_TABLE_SIZE) {
+        if (db->kv_index_ok) {
+            FDB_INFO("Warning: The KV index table is full. Please increase the FDB_KV_INDEX_TABLE_SIZE.\n");
+        }
+        /* some KV is NOT indexed, so the index miss result is untrusted */
+        db->kv_index_ok = false;
+        return;
+    }
+    db->kv_index_table[i].name_crc = name_crc;
+    db->kv_index_table[i].addr = addr;
+    db->kv_index_num++;
+}
+
+/*
+ * Remove the KV from index. Only the node which is pointing to the KV address will be removed.
+ */
+static void remove_kv_index(fdb_kvdb_t db, const char *name, size_t name_len, uint32_t addr)
+{
+    uint32_t name_crc = fdb_calc_crc32(0, name, name_len);
+    size_t i, j, home;
+
+    for (i = name_crc & KV_INDEX_MASK; db->kv_index_table[i].addr != FDB_DATA_UNUSED; i = (i + 1) & KV_INDEX_MASK) {
+        if (db->kv_index_table[i].addr == addr) {
+            break;
+        }
+    }
+    if (db->kv_index_table[i].addr == FDB_DATA_UNUSED) {
+        return;
+    }
+    db->kv_index_num--;
+    /* backward shift the following nodes, so the probing chain is NOT broken */
+    for (j = i;;) {
+        db->kv_index_table[i].addr = FDB_DATA_UNUSED;
+        do {
+            j = (j + 1) & KV_INDEX_MASK;
+            if (db->kv_index_table[j].addr == FDB_DATA_UNUSED) {
+                return;
+            }
+            home = db->kv_index_table[j].name_crc & KV_INDEX_MASK;
+        } while (i <= j ? (i < home && home <= j) : (i < home || home <= j));
+        db->kv_index_table[i] = db->kv_index_table[j];
+        i = j;
+    }
+}
+
+/*
+ * Get KV address from index. It's return true when index is hit.
+ */
+static bool get_kv_from_index(fdb_kvdb_t db, const char *name, size_t name_len, uint32_t *addr)
+{
+    uint32_t name_crc = fdb_calc_crc32(0, name, name_len);
+    size_t i;
+
+    for (i = name_crc & KV_INDEX_MASK; db->kv_index_table[i].addr != FDB_DATA_UNUSED; i = (i + 1) & KV_INDEX_MASK) {
+        if (db->kv_index_table[i].name_crc == name_crc
+                && kv_index_name_match(db, db->kv_index_table[i].addr, name, name_len)) {
+            *addr = db->kv_index_table[i].addr;
+            return true;
+        }
+    }
+
+    return false;
+}
+#endif /* FDB_KV_USING_INDEX */
+
+#ifdef FDB_KV_USING_MISS_CACHE
+static bool kv_miss_cache_match(kv_miss_cache_node_t node, const char *name, size_t name_len, uint32_t name_crc)
+{
+    return node->name_crc == name_crc && name_len <= FDB_KV_NAME_MAX && !memcmp(node->name, name, name_len)
+            && (name_len == FDB_KV_NAME_MAX || node->name[name_len] == '\0');
+}
+
+static void add_kv_miss_cache(fdb_kvdb_t db, const char *name, size_t name_len, uint32_t name_crc)
+{
+    kv_miss_cache_node_t node;
+
+    if (name_len > FDB_KV_NAME_MAX) {
+        /* the KV name is too long, it's never created */
+        return;
+    }
+    if (db->kv_miss_cache_num < FDB_KV_MISS_CACHE_TABLE_SIZE) {
+        node = &db->kv_miss_cache_table[db->kv_miss_cache_num++];
+    } else {
+        /* replace the node in turn when the table is full */
+        node = &db->kv_miss_cache_table[db->kv_miss_cache_next];
+        db->kv_miss_cache_next = (db->kv_miss_cache_next + 1) % FDB_KV_MISS_CACHE_TABLE_SIZE;
+    }
+    node->name_crc = name_crc;
+    memcpy(node->name, name, name_len);
+    if (name_len < FDB_KV_NAME_MAX) {
+        node->name[name_len] = '\0';
+    }
+}
+
+static void remove_kv_miss_cache(fdb_kvdb_t db, const char *name, size_t name_len, uint32_t name_crc)
+{
+    size_t i;
+
+    for (i = 0; i < db->kv_miss_cache_num;) {
+        if (kv_miss_cache_match(&db->kv_miss_cache_table[i], name, name_len, name_crc)) {
+            db->kv_miss_cache_table[i] = db->kv_miss_cache_table[--db->kv_miss_cache_num];
+        } else {
+            i++;
+        }
+    }
+}
+
+/*
+ * Check the KV is in the miss cache. It's return true when the KV is NOT exist.
+ */
+static bool get_kv_from_miss_cache(fdb_kvdb_t db, const char *name, size_t name_len, uint32_t name_crc)
+{
+    size_t i;
+
+    for (i = 0; i < db->kv_miss_cache_num; i++) {
+        if (kv_miss_cache_match(&db->kv_miss_cache_table[i], name, name_len, name_crc)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+#endif /* FDB_KV_USING_MISS_CACHE */
+
+#ifdef FDB_KV_USING_WRITE_BUF
+/* the write buffer node is: node header + name + '\0' + value, it's aligned by 4 bytes */
+struct kv_write_buf_node {
+    uint32_t name_len;
+    uint32_t value_len;
+};
+
+#define KV_WRITE_BUF_NODE_SIZE(name_len, value_len) \
+    FDB_ALIGN(sizeof(struct kv_write_buf_node) + (name_len) + 1 + (value_len), 4)
+
+/*
+ * Find the KV in the write buffer. It's return the node offset in write buffer, or -1 when not found.
+ */
+static int32_t find_kv_in_write_buf(fdb_kvdb_t db, const char *key, struct kv_write_buf_node *node)
+{
+    size_t offset, key_len = strlen(key);
+
+    for (offset = 0; offset < db->write_buf_used; offset += KV_WRITE_BUF_NODE_SIZE(node->name_len, node->value_len)) {
+        memcpy(node, db->write_buf + offset, sizeof(struct kv_write_buf_node));
+        if (node->name_len == key_len && !memcmp(db->write_buf + offset + sizeof(struct kv_write_buf_node), key, key_len)) {
+            return (int32_t)offset;
+        }
+    }
+
+    return -1;
+}
+
+static void remove_kv_in_write_buf(fdb_kvdb_t db, size_t offset, struct kv_write_buf_node *node)
+{
+    size_t node_size = KV_WRITE_BUF_NODE_SIZE(node->name_len, node->value_len);
+
+    memmove(db->write_buf + offset, db->write_buf + offset + node_size, db->write_buf_used - offset - node_size);
+    db->write_buf_used -= node_size;
+}
+
+/*
+ * Get the KV value from the write buffer. It's return false when the KV is NOT in the write buffer.
+ */
+static bool get_kv_from_write_buf(fdb_kvdb_t db, const char *key, void *value_buf, size_t buf_len, size_t *read_len,
+        size_t *value_len)
+{
+    struct kv_write_buf_node node;
+    int32_t offset = find_kv_in_write_buf(db, key, &node);
+
+    if (offset < 0) {
+        return false;
+    }
+    if (value_len) {
+        *value_len = node.value_len;
+    }
+    *read_len = buf_len > node.value_len ? node.value_len : buf_len;
+    if (value_buf) {
+        memcpy(value_buf, db->write_buf + offset + sizeof(struct kv_write_buf_node) + node.name_len + 1, *read_len);
+    }
+
+    return true;
+}
+#endif /* FDB_KV_USING_WRITE_BUF */
+
+#ifdef FDB_KV_USING_SECTOR_SUMMARY
+/* the hash number for each KV name in bloom filter */
+#define KV_BLOOM_HASH_NUM                        3
+#define KV_BLOOM_BITS                            (FDB_KV_BLOOM_FILTER_SIZE * 8)
+
+static kv_sec_summary_t get_sector_summary(fdb_kvdb_t db, uint32_t sec_addr)
+{
+    uint32_t index = sec_addr / db_sec_size(db);
+
+    if (index < FDB_KV_SECTOR_SUMMARY_TABLE_SIZE) {
+        return &db->sector_summary_table[index];
+    }
+
+    return NULL;
+}
+
+static void clean_sector_summary(fdb_kvdb_t db, uint32_t sec_addr)
+{
+    kv_sec_summary_t summary = get_sector_summary(db, sec_addr);
+
+    if (summary) {
+        memset(summary->bloom, 0, sizeof(summary->bloom));
+#ifdef FDB_KV_GC_COST_BENEFIT
+        summary->live_size = 0;
+        summary->dead_size = 0;
+#endif
+    }
+}
+
+/*
+ * Add the KV name CRC32 to the bloom filter. The hash values are generated by double hashing.
+ */
+static void update_sector_summary(fdb_kvdb_t db, uint32_t sec_addr, uint32_t name_crc)
+{
+    kv_sec_summary_t summary = get_sector_summary(db, sec_addr);
+    uint32_t i, bit, delta = ((name_crc >> 17) | (name_crc << 15)) | 1;
+
+    if (summary) {
+        for (i = 0, bit = name_crc; i < KV_BLOOM_HASH_NUM; i++, bit += delta) {
+            summary->bloom[(bit % KV_BLOOM_BITS) / 8] |= 1 << (bit % 8);
+        }
+    }
+}
+
+/*
+ * Check the KV name CRC32 in the bloom filter. It's return false when the KV is NOT in the sector.
+ */
+static bool sector_summary_may_has_kv(fdb_kvdb_t db, uint32_t sec_addr, uint32_t name_crc)
+{
+    kv_sec_summary_t summary = get_sector_summary(db, sec_addr);
+    uint32_t i, bit, delta = ((name_crc >> 17) | (name_crc << 15)) | 1;
+
+    /* the summary is building or it's not in summary table */
+    if (!db->sector_summary_ok || db->in_recovery_check || !summary) {
+        return true;
+    }
+    for (i = 0, bit = name_crc; i < KV_BLOOM_HASH_NUM; i++, bit += delta) {
+        if (!(summary->bloom[(bit % KV_BLOOM_BITS) / 8] & (1 << (bit % 8)))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#ifdef FDB_KV_GC_COST_BENEFIT
+/*
+ * Account the KV size to the sector live or dead size. The FDB_KV_WRITE KV is live, the FDB_KV_DELETED KV is moved
+ * from live to dead, and others are dead. It's built after the KVDB load, so it's NOT accounted in recovery check.
+ */
+static void update_sector_usage(fdb_kvdb_t db, uint32_t kv_addr, uint32_t kv_len, fdb_kv_status_t status)
+{
+    kv_sec_summary_t summary = get_sector_summary(db, FDB_ALIGN_DOWN(kv_addr, db_sec_size(db)));
+
+    if (!db->sector_summary_ok || !summary) {
+        return;
+    }
+    if (status == FDB_KV_WRITE) {
+        summary->live_size += kv_len;
+    } else {
+        if (status == FDB_KV_DELETED) {
+            summary->live_size = summary->live_size > kv_len ? summary->live_size - kv_len : 0;
+        }
+        summary->dead_size += kv_len;
+    }
+}
+#endif /* FDB_KV_GC_COST_BENEFIT */
+#endif /* FDB_KV_USING_SECTOR_SUMMARY */
+
 /*
  * find the next KV address by magic word on the flash
  */
 static uint32_t find_next_kv_addr(fdb_kvdb_t db, uint32_t start, uint32_t end)
 {
-    uint8_t buf[32];
-    uint32_t start_bak = start, i;
-    uint32_t magic;
+    uint32_t buf[FDB_SCAN_BUF_SIZE / sizeof(uint32_t)];
+    uint32_t start_bak = start, magic = KV_MAGIC_WORD, kv_addr;
+    const uint8_t *data = (uint8_t *) buf, *map, *found, *last;
+    size_t read_size;
 
 #ifdef FDB_KV_USING_CACHE
     kv_sec_info_t sector;
@@ -291,19 +673,34 @@ static uint32_t find_next_kv_addr(fdb_kvdb_t db, uint32_t start, uint32_t end)
     }
 #endif /* FDB_KV_USING_CACHE */
 
-    for (; start < end && start + sizeof(buf) < end; start += (sizeof(buf) - sizeof(uint32_t))) {
-        if (_fdb_flash_read((fdb_db_t)db, start, (uint32_t *) buf, sizeof(buf)) != FDB_NO_ERR)
+    /* scan the whole range without copying when the storage is directly addressable */
+    map = start < end ? _fdb_flash_map((fdb_db_t)db, start, end - start) : NULL;
+    /* the adjacent blocks are overlapped by a word, so the magic word across the blocks will NOT be missed */
+    for (; start + sizeof(uint32_t) <= end; start += read_size - sizeof(uint32_t)) {
+        if (map) {
+            read_size = end - start;
+            data = map;
+        } else if (start + sizeof(buf) < end) {
+            read_size = sizeof(buf);
+        } else {
+            read_size = end - start;
+        }
+        if (!map && _fdb_flash_read((fdb_db_t)db, start, buf, read_size) != FDB_NO_ERR)
             return FAILED_ADDR;
-        for (i = 0; i < sizeof(buf) - sizeof(uint32_t) && start + i < end; i++) {
-#ifndef FDB_BIG_ENDIAN            /* Little Endian Order */
-            magic = buf[i] + ((uint32_t)buf[i + 1] << 8) + ((uint32_t)buf[i + 2] << 16) + ((uint32_t)buf[i + 3] << 24);
-#else                       /* Big Endian Order */
-            magic = buf[i + 3] + ((uint32_t)buf[i + 2] << 8) + ((uint32_t)buf[i + 1] << 16) + ((uint32_t)buf[i] << 24);
-#endif
-            if (magic == KV_MAGIC_WORD && (start + i - KV_MAGIC_OFFSET) >= start_bak) {
-                return start + i - KV_MAGIC_OFFSET;
+        /* locate the first byte of magic word by memchr, then compare the whole word in the native byte order */
+        for (found = data, last = data + read_size - sizeof(uint32_t); found <= last; found++) {
+            found = memchr(found, *(uint8_t *)&magic, last - found + 1);
+            if (found == NULL) {
+                break;
+            }
+            kv_addr = start + (found - data) - KV_MAGIC_OFFSET;
+            if (!memcmp(found, &magic, sizeof(uint32_t)) && kv_addr >= start_bak) {
+                return kv_addr;
             }
         }
+        if (map || read_size < sizeof(buf)) {
+            break;
+        }
     }
 
     return FAILED_ADDR;
@@ -345,17 +742,66 @@ static uint32_t get_next_kv_addr(fdb_kvdb_t db, kv_sec_info_t sector, fdb_kv_t p
     return addr;
 }
 
-static fdb_err_t read_kv(fdb_kvdb_t db, fdb_kv_t kv)
+/*
+ * Calculate the KV CRC32 by the name and value on the flash.
+ * The value will be copied to the value_buf at the same time when it's not NULL.
+ */
+static uint32_t calc_kv_crc32(fdb_kvdb_t db, uint32_t addr, kv_hdr_data_t kv_hdr, void *value_buf, size_t buf_len)
 {
-    struct kv_hdr_data kv_hdr;
     uint8_t buf[32];
-    uint32_t calc_crc32 = 0, crc_data_len, kv_name_addr;
+    const uint8_t *map;
+    uint32_t calc_crc32 = 0, crc_data_len = kv_hdr->len - KV_HDR_DATA_SIZE;
+    size_t len, size, value_start = FDB_WG_ALIGN(kv_hdr->name_len), value_end, copy_start, copy_end;
+
+    value_end = value_start + (buf_len < kv_hdr->value_len ? buf_len : kv_hdr->value_len);
+    /* CRC32 data len(header.name_len + header.value_len + name + value), using sizeof(uint32_t) for compatible V1.x */
+    calc_crc32 = fdb_calc_crc32(calc_crc32, &kv_hdr->name_len, sizeof(uint32_t));
+    calc_crc32 = fdb_calc_crc32(calc_crc32, &kv_hdr->value_len, sizeof(uint32_t));
+    /* calculate and copy on the flash data directly when the storage is directly addressable */
+    map = _fdb_flash_map((fdb_db_t)db, addr + KV_HDR_DATA_SIZE, crc_data_len);
+    if (map) {
+        if (value_buf && value_start < value_end) {
+            memcpy(value_buf, map + value_start, value_end - value_start);
+        }
+        return fdb_calc_crc32(calc_crc32, map, crc_data_len);
+    }
+    /* calculate the CRC32 value */
+    for (len = 0, size = 0; len < crc_data_len; len += size) {
+        if (len + sizeof(buf) < crc_data_len) {
+            size = sizeof(buf);
+        } else {
+            size = crc_data_len - len;
+        }
+
+        _fdb_flash_read((fdb_db_t)db, addr + KV_HDR_DATA_SIZE + len, (uint32_t *) buf, FDB_WG_ALIGN(size));
+        calc_crc32 = fdb_calc_crc32(calc_crc32, buf, size);
+        /* copy the value part in the buffer */
+        if (value_buf) {
+            copy_start = len > value_start ? len : value_start;
+            copy_end = len + size < value_end ? len + size : value_end;
+            if (copy_start < copy_end) {
+                memcpy((uint8_t *)value_buf + copy_start - value_start, buf + copy_start - len, copy_end - copy_start);
+            }
+        }
+    }
+
+    return calc_crc32;
+}
+
+/*
+ * Read the KV. The CRC32 check will be deferred when check_crc is false,
+ * then only the header and name is read, and crc_is_checked will be false.
+ */
+static fdb_err_t read_kv_ex(fdb_kvdb_t db, fdb_kv_t kv, bool check_crc)
+{
+    struct kv_hdr_data kv_hdr;
+    uint32_t kv_name_addr;
     fdb_err_t result = FDB_NO_ERR;
-    size_t len, size;
     /* read KV header raw data */
     _fdb_flash_read((fdb_db_t)db, kv->addr.start, (uint32_t *)&kv_hdr, sizeof(struct kv_hdr_data));
     kv->status = (fdb_kv_status_t) _fdb_get_status(kv_hdr.status_table, FDB_KV_STATUS_NUM);
     kv->len = kv_hdr.len;
+    kv->crc_is_checked = true;
 
     if (kv->len == UINT32_MAX || kv->len > db_max_size(db) || kv->len < KV_HDR_DATA_SIZE) {
         /* the KV length was not write, so reserved the info for current KV */
@@ -371,32 +817,23 @@ static fdb_err_t read_kv(fdb_kvdb_t db, fdb_kv_t kv)
         //TODO Sector continuous mode, or the write length is not written completely
     }
 
-    /* CRC32 data len(header.name_len + header.value_len + name + value), using sizeof(uint32_t) for compatible V1.x */
-    calc_crc32 = fdb_calc_crc32(calc_crc32, &kv_hdr.name_len, sizeof(uint32_t));
-    calc_crc32 = fdb_calc_crc32(calc_crc32, &kv_hdr.value_len, sizeof(uint32_t));
-    crc_data_len = kv->len - KV_HDR_DATA_SIZE;
-    /* calculate the CRC32 value */
-    for (len = 0, size = 0; len < crc_data_len; len += size) {
-        if (len + sizeof(buf) < crc_data_len) {
-            size = sizeof(buf);
-        } else {
-            size = crc_data_len - len;
-        }
-
-        _fdb_flash_read((fdb_db_t)db, kv->addr.start + KV_HDR_DATA_SIZE + len, (uint32_t *) buf, FDB_WG_ALIGN(size));
-        calc_crc32 = fdb_calc_crc32(calc_crc32, buf, size);
+    if (!check_crc && kv_hdr.name_len <= FDB_KV_NAME_MAX
+            && kv->len == KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv_hdr.name_len) + FDB_WG_ALIGN(kv_hdr.value_len)) {
+        /* the header is looks good, so the CRC32 check is deferred */
+        kv->crc_is_ok = true;
+        kv->crc_is_checked = false;
+    } else {
+        kv->crc_is_ok = calc_kv_crc32(db, kv->addr.start, &kv_hdr, NULL, 0) == kv_hdr.crc32;
     }
     /* check CRC32 */
-    if (calc_crc32 != kv_hdr.crc32) {
+    if (!kv->crc_is_ok) {
         size_t name_len = kv_hdr.name_len > FDB_KV_NAME_MAX ? FDB_KV_NAME_MAX : kv_hdr.name_len;
-        kv->crc_is_ok = false;
         result = FDB_READ_ERR;
         /* try read the KV name, maybe read name has error */
         kv_name_addr = kv->addr.start + KV_HDR_DATA_SIZE;
         _fdb_flash_read((fdb_db_t)db, kv_name_addr, (uint32_t *)kv->name, FDB_WG_ALIGN(name_len));
         FDB_INFO("Error: Read the KV (%.*s@0x%08" PRIX32 ") CRC32 check failed!\n", name_len, kv->name, kv->addr.start);
     } else {
-        kv->crc_is_ok = true;
         /* the name is behind aligned KV header */
         kv_name_addr = kv->addr.start + KV_HDR_DATA_SIZE;
         _fdb_flash_read((fdb_db_t)db, kv_name_addr, (uint32_t *) kv->name, FDB_WG_ALIGN(kv_hdr.name_len));
@@ -413,6 +850,29 @@ static fdb_err_t read_kv(fdb_kvdb_t db, fdb_kv_t kv)
     return result;
 }
 
+static fdb_err_t read_kv(fdb_kvdb_t db, fdb_kv_t kv)
+{
+    return read_kv_ex(db, kv, true);
+}
+
+/*
+ * Check the deferred CRC32 of the KV which is read by read_kv_ex(db, kv, false).
+ * The value will be read to the value_buf at the same time when it's not NULL.
+ */
+static bool check_kv_crc(fdb_kvdb_t db, fdb_kv_t kv, void *value_buf, size_t buf_len)
+{
+    struct kv_hdr_data kv_hdr;
+
+    _fdb_flash_read((fdb_db_t)db, kv->addr.start, (uint32_t *)&kv_hdr, sizeof(struct kv_hdr_data));
+    kv->crc_is_ok = calc_kv_crc32(db, kv->addr.start, &kv_hdr, value_buf, buf_len) == kv_hdr.crc32;
+    kv->crc_is_checked = true;
+    if (!kv->crc_is_ok) {
+        FDB_INFO("Error: Read the KV (%.*s@0x%08" PRIX32 ") CRC32 check failed!\n", kv->name_len, kv->name, kv->addr.start);
+    }
+
+    return kv->crc_is_ok;
+}
+
 static fdb_err_t read_sector_info(fdb_kvdb_t db, uint32_t addr, kv_sec_info_t sector, bool traversal)
 {
     fdb_err_t result = FDB_NO_ERR;
@@ -421,6 +881,13 @@ static fdb_err_t read_sector_info(fdb_kvdb_t db, uint32_t addr, kv_sec_info_t se
     FDB_ASSERT(addr % db_sec_size(db) == 0);
     FDB_ASSERT(sector);
 
+#ifdef FDB_KV_USING_SECTOR_TABLE
+    if (db->sector_table_ok) {
+        memcpy(sector, &db->sector_table[addr / db_sec_size(db)], sizeof(struct kvdb_sec_info));
+        return sector->check_ok ? FDB_NO_ERR : FDB_INIT_FAILED;
+    }
+#endif /* FDB_KV_USING_SECTOR_TABLE */
+
 #ifdef FDB_KV_USING_CACHE
     kv_sec_info_t sector_cache = get_sector_from_cache(db, addr);
     if (sector_cache && ((!traversal) || (traversal && sector_cache->empty_kv != FAILED_ADDR))) {
@@ -576,32 +1043,99 @@ static bool find_kv_cb(fdb_kv_t kv, void *arg1, void *arg2)
 static bool find_kv_no_cache(fdb_kvdb_t db, const char *key, fdb_kv_t kv)
 {
     bool find_ok = false;
+    struct kvdb_sec_info sector;
+    uint32_t sec_addr, traversed_len = 0;
+#ifdef FDB_KV_USING_SECTOR_SUMMARY
+    uint32_t name_crc = fdb_calc_crc32(0, key, strlen(key));
+#endif
 
-    kv_iterator(db, kv, (void *)key, &find_ok, find_kv_cb);
-
-    return find_ok;
-}
-
-static bool find_kv(fdb_kvdb_t db, const char *key, fdb_kv_t kv)
+    sec_addr = db_oldest_addr(db);
+    /* search all sectors, skip the sector which summary is NOT matched */
+    do {
+        traversed_len += db_sec_size(db);
+        if (read_sector_info(db, sec_addr, &sector, false) != FDB_NO_ERR) {
+            continue;
+        }
+        if (sector.status.store != FDB_SECTOR_STORE_USING && sector.status.store != FDB_SECTOR_STORE_FULL) {
+            continue;
+        }
+#ifdef FDB_KV_USING_SECTOR_SUMMARY
+        if (!sector_summary_may_has_kv(db, sector.addr, name_crc)) {
+            continue;
+        }
+#endif
+        kv->addr.start = sector.addr + SECTOR_HDR_DATA_SIZE;
+        /* search all KV, only read the header and name */
+        do {
+            read_kv_ex(db, kv, false);
+            if (find_kv_cb(kv, (void *)key, &find_ok)) {
+                /* only check the CRC32 of the matched KV */
+                if (kv->crc_is_checked || check_kv_crc(db, kv, NULL, 0)) {
+                    return true;
+                }
+                find_ok = false;
+            }
+        } while ((kv->addr.start = get_next_kv_addr(db, &sector, kv)) != FAILED_ADDR);
+    } while ((sec_addr = get_next_sector_addr(db, &sector, traversed_len)) != FAILED_ADDR);
+
+    return find_ok;
+}
+
+static bool find_kv(fdb_kvdb_t db, const char *key, fdb_kv_t kv)
 {
     bool find_ok = false;
+#ifdef FDB_KV_USING_MISS_CACHE
+    size_t name_len;
+    uint32_t name_crc;
+#endif
 
-#ifdef FDB_KV_USING_CACHE
+#if defined(FDB_KV_USING_INDEX)
+    size_t key_len = strlen(key);
+
+    if (get_kv_from_index(db, key, key_len, &kv->addr.start)) {
+        /* the CRC32 will be checked when the value is read */
+        read_kv_ex(db, kv, false);
+        return true;
+    } else if (db->kv_index_ok && !db->in_recovery_check) {
+        /* all KV has been indexed, so it's NOT exist */
+        return false;
+    }
+#elif defined(FDB_KV_USING_CACHE)
     size_t key_len = strlen(key);
 
     if (get_kv_from_cache(db, key, key_len, &kv->addr.start)) {
-        read_kv(db, kv);
+        /* the CRC32 will be checked when the value is read */
+        read_kv_ex(db, kv, false);
         return true;
     }
-#endif /* FDB_KV_USING_CACHE */
+#endif /* FDB_KV_USING_INDEX */
+
+#ifdef FDB_KV_USING_MISS_CACHE
+    name_len = strlen(key);
+    name_crc = fdb_calc_crc32(0, key, name_len);
+    /* the KV was missed recently and it's NOT created after that */
+    if (!db->in_recovery_check && get_kv_from_miss_cache(db, key, name_len, name_crc)) {
+        return false;
+    }
+#endif /* FDB_KV_USING_MISS_CACHE */
 
     find_ok = find_kv_no_cache(db, key, kv);
 
-#ifdef FDB_KV_USING_CACHE
+#ifdef FDB_KV_USING_MISS_CACHE
+    if (!find_ok && !db->in_recovery_check) {
+        add_kv_miss_cache(db, key, name_len, name_crc);
+    }
+#endif /* FDB_KV_USING_MISS_CACHE */
+
+#if defined(FDB_KV_USING_INDEX)
+    if (find_ok) {
+        update_kv_index(db, key, key_len, kv->addr.start);
+    }
+#elif defined(FDB_KV_USING_CACHE)
     if (find_ok) {
         update_kv_cache(db, key, key_len, kv->addr.start);
     }
-#endif /* FDB_KV_USING_CACHE */
+#endif /* FDB_KV_USING_INDEX */
 
     return find_ok;
 }
@@ -624,6 +1158,13 @@ static size_t get_kv(fdb_kvdb_t db, const char *key, void *value_buf, size_t buf
     struct fdb_kv kv;
     size_t read_len = 0;
 
+#ifdef FDB_KV_USING_WRITE_BUF
+    /* the KV in write buffer is newer than flash */
+    if (get_kv_from_write_buf(db, key, value_buf, buf_len, &read_len, value_len)) {
+        return read_len;
+    }
+#endif
+
     if (find_kv(db, key, &kv)) {
         if (value_len) {
             *value_len = kv.value_len;
@@ -633,7 +1174,15 @@ static size_t get_kv(fdb_kvdb_t db, const char *key, void *value_buf, size_t buf
         } else {
             read_len = buf_len;
         }
-        if (value_buf){
+        if (!kv.crc_is_checked) {
+            /* check the CRC32 and read the value at the same time */
+            if (!check_kv_crc(db, &kv, value_buf, read_len)) {
+                read_len = 0;
+                if (value_len) {
+                    *value_len = 0;
+                }
+            }
+        } else if (value_buf){
             _fdb_flash_read((fdb_db_t)db, kv.addr.value, (uint32_t *) value_buf, read_len);
         }
     } else if (value_len) {
@@ -664,7 +1213,16 @@ fdb_kv_t fdb_kv_get_obj(fdb_kvdb_t db, const char *key, fdb_kv_t kv)
     /* lock the KV cache */
     db_lock(db);
 
+#ifdef FDB_KV_USING_WRITE_BUF
+    /* the KV object is located in flash, so flush it first */
+    flush_write_buf(db, key);
+#endif
+
     find_ok = find_kv(db, key, kv);
+    /* the KV object will be used by user, so it MUST be checked */
+    if (find_ok && !kv->crc_is_checked) {
+        find_ok = check_kv_crc(db, kv, NULL, 0);
+    }
 
     /* unlock the KV cache */
     db_unlock(db);
@@ -689,6 +1247,57 @@ fdb_blob_t fdb_kv_to_blob(fdb_kv_t kv, fdb_blob_t blob)
     return blob;
 }
 
+/**
+ * Get the KV value pointer without copying, it's only supported when the storage is directly
+ * addressable, such as the mmap file mode or the FAL XIP flash.
+ * The pointer is valid until the database generation (fdb_db_generation) is changed.
+ *
+ * @param db database object
+ * @param key KV name
+ * @param value_len the KV value length
+ * @param generation the database generation when getting the pointer, it can be NULL
+ *
+ * @return the KV value pointer, NULL when the KV is NOT found or the storage is NOT addressable
+ */
+const void *fdb_kv_get_ptr(fdb_kvdb_t db, const char *key, size_t *value_len, uint32_t *generation)
+{
+    struct fdb_kv kv;
+    bool find_ok = false;
+    const void *value = NULL;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: KV (%s) isn't initialize OK.\n", db_name(db));
+        return NULL;
+    }
+
+    /* lock the KV cache */
+    db_lock(db);
+
+#ifdef FDB_KV_USING_WRITE_BUF
+    /* the KV value is located in flash, so flush it first */
+    flush_write_buf(db, key);
+#endif
+
+    find_ok = find_kv(db, key, &kv);
+    if (find_ok && !kv.crc_is_checked) {
+        find_ok = check_kv_crc(db, &kv, NULL, 0);
+    }
+    if (find_ok) {
+        value = _fdb_flash_map((fdb_db_t)db, kv.addr.value, kv.value_len);
+    }
+    if (value) {
+        *value_len = kv.value_len;
+        if (generation) {
+            *generation = db->parent.generation;
+        }
+    }
+
+    /* unlock the KV cache */
+    db_unlock(db);
+
+    return value;
+}
+
 /**
  * Get a blob KV value by key name.
  *
@@ -711,6 +1320,9 @@ size_t fdb_kv_get_blob(fdb_kvdb_t db, const char *key, fdb_blob_t blob)
     db_lock(db);
 
     read_len = get_kv(db, key, blob->buf, blob->size, &blob->saved.len);
+#ifdef FDB_KV_USING_WRITE_BUF
+    check_write_buf_timeout(db);
+#endif
 
     /* unlock the KV cache */
     db_unlock(db);
@@ -752,20 +1364,6 @@ char *fdb_kv_get(fdb_kvdb_t db, const char *key)
     return NULL;
 }
 
-static fdb_err_t write_kv_hdr(fdb_kvdb_t db, uint32_t addr, kv_hdr_data_t kv_hdr)
-{
-    fdb_err_t result = FDB_NO_ERR;
-    /* write the status will by write granularity */
-    result = _fdb_write_status((fdb_db_t)db, addr, kv_hdr->status_table, FDB_KV_STATUS_NUM, FDB_KV_PRE_WRITE, false);
-    if (result != FDB_NO_ERR) {
-        return result;
-    }
-    /* write other header data */
-    result = _fdb_flash_write((fdb_db_t)db, addr + KV_MAGIC_OFFSET, &kv_hdr->magic, sizeof(struct kv_hdr_data) - KV_MAGIC_OFFSET, false);
-
-    return result;
-}
-
 static fdb_err_t format_sector(fdb_kvdb_t db, uint32_t addr, uint32_t combined_value)
 {
     fdb_err_t result = FDB_NO_ERR;
@@ -814,9 +1412,25 @@ static fdb_err_t format_sector(fdb_kvdb_t db, uint32_t addr, uint32_t combined_v
                                   true);
 #endif
 
+#ifdef FDB_KV_USING_SECTOR_SUMMARY
+        clean_sector_summary(db, addr);
+#endif
+
 #ifdef FDB_KV_USING_CACHE
         {
             struct kvdb_sec_info sector = {.addr = addr, .check_ok = false, .empty_kv = FAILED_ADDR };
+#ifdef FDB_KV_USING_SECTOR_TABLE
+            /* the sector table keeps all sectors, so the formatted sector info is updated to it */
+            if (db->sector_table_ok && result == FDB_NO_ERR) {
+                sector.check_ok = true;
+                sector.status.store = FDB_SECTOR_STORE_EMPTY;
+                sector.status.dirty = FDB_SECTOR_DIRTY_FALSE;
+                sector.magic = SECTOR_MAGIC_WORD;
+                sector.combined = combined_value;
+                sector.remain = db_sec_size(db) - SECTOR_HDR_DATA_SIZE;
+                sector.empty_kv = addr + SECTOR_HDR_DATA_SIZE;
+            }
+#endif
             /* delete the sector cache */
             update_sector_cache(db, &sector);
         }
@@ -912,12 +1526,65 @@ static bool alloc_kv_cb(kv_sec_info_t sector, void *arg1, void *arg2)
     return false;
 }
 
+#ifdef FDB_KV_USING_SECTOR_TABLE
+/*
+ * Alloc the KV by the sector table. It's same as the sector iterator allocation, but all sectors are checked in one
+ * pass without reading flash.
+ */
+static uint32_t alloc_kv_from_table(fdb_kvdb_t db, kv_sec_info_t sector, size_t kv_size)
+{
+    uint32_t empty_kv = FAILED_ADDR, i, sec_num = SECTOR_NUM, oldest_index = db_oldest_addr(db) / db_sec_size(db);
+    size_t empty_sector = 0;
+    struct alloc_kv_cb_args arg = {db, kv_size, &empty_kv};
+    kv_sec_info_t sec_info, empty_sec_info = NULL;
+
+    for (i = 0; i < sec_num; i++) {
+        sec_info = &db->sector_table[(oldest_index + i) % sec_num];
+        if (!sec_info->check_ok) {
+            continue;
+        }
+        if (sec_info->status.store == FDB_SECTOR_STORE_USING) {
+            /* alloc the KV from the using status sector first */
+            if (alloc_kv_cb(sec_info, &arg, NULL)) {
+                memcpy(sector, sec_info, sizeof(struct kvdb_sec_info));
+                return empty_kv;
+            }
+        } else if (sec_info->status.store == FDB_SECTOR_STORE_EMPTY) {
+            empty_sector++;
+            if (!empty_sec_info && alloc_kv_cb(sec_info, &arg, NULL)) {
+                empty_sec_info = sec_info;
+            }
+        }
+    }
+    if (empty_sector > 0) {
+        if (empty_sector > FDB_GC_EMPTY_SEC_THRESHOLD || db->gc_request) {
+            if (empty_sec_info) {
+                memcpy(sector, empty_sec_info, sizeof(struct kvdb_sec_info));
+                return empty_sec_info->empty_kv;
+            }
+        } else {
+            /* no space for new KV now will GC and retry */
+            FDB_DEBUG("Trigger a GC check after alloc KV failed.\n");
+            db->gc_request = true;
+        }
+    }
+
+    return FAILED_ADDR;
+}
+#endif /* FDB_KV_USING_SECTOR_TABLE */
+
 static uint32_t alloc_kv(fdb_kvdb_t db, kv_sec_info_t sector, size_t kv_size)
 {
     uint32_t empty_kv = FAILED_ADDR;
     size_t empty_sector = 0, using_sector = 0;
     struct alloc_kv_cb_args arg = {db, kv_size, &empty_kv};
 
+#ifdef FDB_KV_USING_SECTOR_TABLE
+    if (db->sector_table_ok) {
+        return alloc_kv_from_table(db, sector, kv_size);
+    }
+#endif
+
     /* sector status statistics */
     sector_iterator(db, sector, FDB_SECTOR_STORE_UNUSED, &empty_sector, &using_sector, sector_statistics_cb, false);
     if (using_sector > 0) {
@@ -937,7 +1604,7 @@ static uint32_t alloc_kv(fdb_kvdb_t db, kv_sec_info_t sector, size_t kv_size)
     return empty_kv;
 }
 
-static fdb_err_t del_kv(fdb_kvdb_t db, const char *key, fdb_kv_t old_kv, bool complete_del)
+static fdb_err_t del_kv_ex(fdb_kvdb_t db, const char *key, fdb_kv_t old_kv, bool complete_del, bool sync)
 {
     fdb_err_t result = FDB_NO_ERR;
     uint32_t dirty_status_addr;
@@ -964,10 +1631,19 @@ static fdb_err_t del_kv(fdb_kvdb_t db, const char *key, fdb_kv_t old_kv, bool co
         result = _fdb_write_status((fdb_db_t)db, old_kv->addr.start, status_table, FDB_KV_STATUS_NUM, FDB_KV_PRE_DELETE, false);
         db->last_is_complete_del = true;
     } else {
-        result = _fdb_write_status((fdb_db_t)db, old_kv->addr.start, status_table, FDB_KV_STATUS_NUM, FDB_KV_DELETED, true);
+        result = _fdb_write_status((fdb_db_t)db, old_kv->addr.start, status_table, FDB_KV_STATUS_NUM, FDB_KV_DELETED, sync);
 
+#if defined(FDB_KV_USING_INDEX)
+        /* the index is removed by address, so the moved KV's new index node will be kept */
+        if (result == FDB_NO_ERR) {
+            if (key != NULL) {
+                remove_kv_index(db, key, strlen(key), old_kv->addr.start);
+            } else {
+                remove_kv_index(db, old_kv->name, old_kv->name_len, old_kv->addr.start);
+            }
+        }
+#elif defined(FDB_KV_USING_CACHE)
         if (!db->last_is_complete_del && result == FDB_NO_ERR) {
-#ifdef FDB_KV_USING_CACHE
             /* delete the KV in flash and cache */
             if (key != NULL) {
                 /* when using del_kv(db, key, NULL, true) or del_kv(db, key, kv, true) in fdb_del_kv(db, ) and set_kv(db, ) */
@@ -976,8 +1652,13 @@ static fdb_err_t del_kv(fdb_kvdb_t db, const char *key, fdb_kv_t old_kv, bool co
                 /* when using del_kv(db, NULL, kv, true) in move_kv(db, ) */
                 update_kv_cache(db, old_kv->name, old_kv->name_len, FDB_DATA_UNUSED);
             }
-#endif /* FDB_KV_USING_CACHE */
         }
+#endif /* FDB_KV_USING_INDEX */
+#ifdef FDB_KV_GC_COST_BENEFIT
+        if (result == FDB_NO_ERR) {
+            update_sector_usage(db, old_kv->addr.start, old_kv->len, FDB_KV_DELETED);
+        }
+#endif
 
         db->last_is_complete_del = false;
     }
@@ -986,7 +1667,7 @@ static fdb_err_t del_kv(fdb_kvdb_t db, const char *key, fdb_kv_t old_kv, bool co
     /* read and change the sector dirty status */
     if (result == FDB_NO_ERR
             && _fdb_read_status((fdb_db_t)db, dirty_status_addr, status_table, FDB_SECTOR_DIRTY_STATUS_NUM) == FDB_SECTOR_DIRTY_FALSE) {
-        result = _fdb_write_status((fdb_db_t)db, dirty_status_addr, status_table, FDB_SECTOR_DIRTY_STATUS_NUM, FDB_SECTOR_DIRTY_TRUE, true);
+        result = _fdb_write_status((fdb_db_t)db, dirty_status_addr, status_table, FDB_SECTOR_DIRTY_STATUS_NUM, FDB_SECTOR_DIRTY_TRUE, sync);
 #ifdef FDB_KV_USING_CACHE
         {
             kv_sec_info_t sector_cache = get_sector_from_cache(db, FDB_ALIGN_DOWN(old_kv->addr.start, db_sec_size(db)));
@@ -1000,6 +1681,11 @@ static fdb_err_t del_kv(fdb_kvdb_t db, const char *key, fdb_kv_t old_kv, bool co
     return result;
 }
 
+static fdb_err_t del_kv(fdb_kvdb_t db, const char *key, fdb_kv_t old_kv, bool complete_del)
+{
+    return del_kv_ex(db, key, old_kv, complete_del, true);
+}
+
 /*
  * move the KV to new space
  */
@@ -1032,7 +1718,7 @@ static fdb_err_t move_kv(fdb_kvdb_t db, fdb_kv_t kv)
     }
     /* start move the KV */
     {
-        uint8_t buf[32];
+        uint32_t buf[FDB_KV_MOVE_BUF_SIZE / 4];
         size_t len, size, kv_len = kv->len;
 
         /* update the new KV sector status first */
@@ -1046,16 +1732,28 @@ static fdb_err_t move_kv(fdb_kvdb_t db, fdb_kv_t kv)
             } else {
                 size = kv_len - len;
             }
-            _fdb_flash_read((fdb_db_t)db, kv->addr.start + KV_MAGIC_OFFSET + len, (uint32_t *) buf, FDB_WG_ALIGN(size));
-            result = _fdb_flash_write((fdb_db_t)db, kv_addr + KV_MAGIC_OFFSET + len, (uint32_t *) buf, size, true);
+            _fdb_flash_read((fdb_db_t)db, kv->addr.start + KV_MAGIC_OFFSET + len, buf, FDB_WG_ALIGN(size));
+            /* the KV data is synced with the FDB_KV_WRITE status, same as creating KV */
+            result = _fdb_flash_write((fdb_db_t)db, kv_addr + KV_MAGIC_OFFSET + len, buf, size, false);
         }
         _fdb_write_status((fdb_db_t)db, kv_addr, status_table, FDB_KV_STATUS_NUM, FDB_KV_WRITE, true);
 
 #ifdef FDB_KV_USING_CACHE
         update_sector_empty_addr_cache(db, FDB_ALIGN_DOWN(kv_addr, db_sec_size(db)),
                 kv_addr + KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv->name_len) + FDB_WG_ALIGN(kv->value_len));
+#ifndef FDB_KV_USING_INDEX
         update_kv_cache(db, kv->name, kv->name_len, kv_addr);
+#endif
 #endif /* FDB_KV_USING_CACHE */
+#ifdef FDB_KV_USING_INDEX
+        update_kv_index(db, kv->name, kv->name_len, kv_addr);
+#endif
+#ifdef FDB_KV_USING_SECTOR_SUMMARY
+        update_sector_summary(db, FDB_ALIGN_DOWN(kv_addr, db_sec_size(db)), fdb_calc_crc32(0, kv->name, kv->name_len));
+#endif
+#ifdef FDB_KV_GC_COST_BENEFIT
+        update_sector_usage(db, kv_addr, kv->len, result == FDB_NO_ERR ? FDB_KV_WRITE : FDB_KV_ERR_HDR);
+#endif
     }
 
     FDB_DEBUG("Moved the KV (%.*s) from 0x%08" PRIX32 " to 0x%08" PRIX32 ".\n", kv->name_len, kv->name, kv->addr.start, kv_addr);
@@ -1109,6 +1807,74 @@ static bool gc_check_cb(kv_sec_info_t sector, void *arg1, void *arg2)
 
 }
 
+#ifdef FDB_KV_GC_COST_BENEFIT
+struct gc_select_cb_args {
+    fdb_kvdb_t db;
+    uint32_t sec_addr;
+    uint32_t live_size;
+    uint32_t dead_size;
+};
+
+/*
+ * Select the dirty sector which has the best cost-benefit score (1 - u) / 2u. The u is the live KV size ratio of the
+ * used space, so the score is dead_size / (2 * live_size). The older sector is selected when the score is same.
+ */
+static bool gc_select_cb(kv_sec_info_t sector, void *arg1, void *arg2)
+{
+    struct gc_select_cb_args *arg = arg1;
+    fdb_kvdb_t db = arg->db;
+    kv_sec_summary_t summary;
+    uint32_t live_size, dead_size;
+
+    if (!sector->check_ok || (sector->status.dirty != FDB_SECTOR_DIRTY_TRUE && sector->status.dirty != FDB_SECTOR_DIRTY_GC)) {
+        return false;
+    }
+    /* the interrupted GC sector MUST be collected first */
+    if (sector->status.dirty == FDB_SECTOR_DIRTY_GC) {
+        arg->sec_addr = sector->addr;
+        return true;
+    }
+    summary = db->sector_summary_ok ? get_sector_summary(db, sector->addr) : NULL;
+    if (summary) {
+        live_size = summary->live_size;
+        dead_size = summary->dead_size;
+    } else {
+        /* the sector is NOT in summary table or the summary is building, it has the lowest score */
+        live_size = db_sec_size(db);
+        dead_size = 0;
+    }
+    if (arg->sec_addr == FAILED_ADDR || (uint64_t)dead_size * arg->live_size > (uint64_t)arg->dead_size * live_size) {
+        arg->sec_addr = sector->addr;
+        arg->live_size = live_size;
+        arg->dead_size = dead_size;
+    }
+
+    return false;
+}
+
+static uint32_t select_gc_sector(fdb_kvdb_t db)
+{
+    struct kvdb_sec_info sector;
+    struct gc_select_cb_args arg = { db, FAILED_ADDR, 0, 0 };
+
+    sector_iterator(db, &sector, FDB_SECTOR_STORE_UNUSED, &arg, NULL, gc_select_cb, false);
+
+    return arg.sec_addr;
+}
+#endif /* FDB_KV_GC_COST_BENEFIT */
+
+/* update oldest_addr for next GC sector format */
+static void update_oldest_addr(fdb_kvdb_t db, kv_sec_info_t sector)
+{
+#ifdef FDB_KV_GC_COST_BENEFIT
+    /* the collected sector maybe NOT the oldest by the cost-benefit selection, then the oldest is NOT changed */
+    if (sector->addr != db_oldest_addr(db)) {
+        return;
+    }
+#endif
+    db_oldest_addr(db) = get_next_sector_addr(db, sector, 0);
+}
+
 static bool do_gc(kv_sec_info_t sector, void *arg1, void *arg2)
 {
     struct fdb_kv kv;
@@ -1120,6 +1886,14 @@ static bool do_gc(kv_sec_info_t sector, void *arg1, void *arg2)
         uint8_t status_table[FDB_DIRTY_STATUS_TABLE_SIZE];
         /* change the sector status to GC */
         _fdb_write_status((fdb_db_t)db, sector->addr + SECTOR_DIRTY_OFFSET, status_table, FDB_SECTOR_DIRTY_STATUS_NUM, FDB_SECTOR_DIRTY_GC, true);
+#ifdef FDB_KV_USING_CACHE
+        {
+            kv_sec_info_t sector_cache = get_sector_from_cache(db, sector->addr);
+            if (sector_cache) {
+                sector_cache->status.dirty = FDB_SECTOR_DIRTY_GC;
+            }
+        }
+#endif /* FDB_KV_USING_CACHE */
         /* search all KV */
         kv.addr.start = sector->addr + SECTOR_HDR_DATA_SIZE;
         do {
@@ -1136,8 +1910,7 @@ static bool do_gc(kv_sec_info_t sector, void *arg1, void *arg2)
         format_sector(db, sector->addr, SECTOR_NOT_COMBINED);
         last_gc_sec_addr = gc->last_gc_sec_addr;
         gc->last_gc_sec_addr = sector->addr;
-        /* update oldest_addr for next GC sector format */
-        db_oldest_addr(db) = get_next_sector_addr(db, sector, 0);
+        update_oldest_addr(db, sector);
         FDB_DEBUG("Collect a sector @0x%08" PRIX32 "\n", sector->addr);
         /* the collect new space is in last GC sector */
         struct kvdb_sec_info last_gc_sector;
@@ -1164,115 +1937,577 @@ static void gc_collect_by_free_size(fdb_kvdb_t db, size_t free_size)
     FDB_DEBUG("The remain empty sector is %" PRIu32 ", GC threshold is %" PRIdLEAST16 ".\n", (uint32_t)empty_sec_num, FDB_GC_EMPTY_SEC_THRESHOLD);
     if (empty_sec_num <= FDB_GC_EMPTY_SEC_THRESHOLD) {
         struct gc_cb_args arg = { db, free_size, empty_sec_addr };
+#ifdef FDB_KV_GC_COST_BENEFIT
+        uint32_t sec_addr;
+        size_t i;
+        /* collect the sector which has the best cost-benefit score one by one, each sector is collected once at most */
+        for (i = 0; i < SECTOR_NUM && (sec_addr = select_gc_sector(db)) != FAILED_ADDR; i++) {
+            if (read_sector_info(db, sec_addr, &sector, false) != FDB_NO_ERR || do_gc(&sector, &arg, NULL)) {
+                break;
+            }
+        }
+#else
         sector_iterator(db, &sector, FDB_SECTOR_STORE_UNUSED, &arg, NULL, do_gc, false);
+#endif
+    }
+
+    db->gc_request = false;
+}
+
+/*
+ * The GC will be triggered on the following scene:
+ * 1. alloc an KV when the flash not has enough space
+ * 2. write an KV then the flash not has enough space
+ */
+static void gc_collect(fdb_kvdb_t db)
+{
+    gc_collect_by_free_size(db, db_max_size(db));
+}
+
+static bool gc_step_check_cb(kv_sec_info_t sector, void *arg1, void *arg2)
+{
+    uint32_t *sec_addr = arg1;
+
+    if (sector->check_ok && (sector->status.dirty == FDB_SECTOR_DIRTY_TRUE || sector->status.dirty == FDB_SECTOR_DIRTY_GC)) {
+        *sec_addr = sector->addr;
+        return true;
+    }
+
+    return false;
+}
+
+/*
+ * Collect a part of the dirty sector, it's return true when the dirty sector still exists and can be collected.
+ */
+static bool gc_step(fdb_kvdb_t db, size_t budget)
+{
+    struct kvdb_sec_info sector, alloc_sector;
+    struct fdb_kv kv;
+    size_t moved_size = 0;
+    uint32_t sec_addr = FAILED_ADDR;
+    bool gc_request = db->gc_request;
+
+    /* the collecting sector maybe already collected by the foreground GC */
+    if (db->gc_step_sec_addr != FAILED_ADDR && (read_sector_info(db, db->gc_step_sec_addr, &sector, false) != FDB_NO_ERR
+            || sector.status.dirty != FDB_SECTOR_DIRTY_GC)) {
+        db->gc_step_sec_addr = FAILED_ADDR;
+    }
+    if (db->gc_step_sec_addr == FAILED_ADDR) {
+        uint8_t status_table[FDB_DIRTY_STATUS_TABLE_SIZE];
+#ifdef FDB_KV_GC_COST_BENEFIT
+        if ((sec_addr = select_gc_sector(db)) != FAILED_ADDR) {
+            read_sector_info(db, sec_addr, &sector, false);
+        }
+#else
+        /* find the dirty sector from the oldest sector, same as the foreground GC */
+        sector_iterator(db, &sector, FDB_SECTOR_STORE_UNUSED, &sec_addr, NULL, gc_step_check_cb, false);
+#endif
+        if (sec_addr == FAILED_ADDR) {
+            return false;
+        }
+        /* change the sector status to GC, so it will be resumed by the GC recovery after power off */
+        if (_fdb_write_status((fdb_db_t)db, sec_addr + SECTOR_DIRTY_OFFSET, status_table, FDB_SECTOR_DIRTY_STATUS_NUM,
+                FDB_SECTOR_DIRTY_GC, true) != FDB_NO_ERR) {
+            return true;
+        }
+#ifdef FDB_KV_USING_CACHE
+        {
+            kv_sec_info_t sector_cache = get_sector_from_cache(db, sec_addr);
+            if (sector_cache) {
+                sector_cache->status.dirty = FDB_SECTOR_DIRTY_GC;
+            }
+        }
+#endif /* FDB_KV_USING_CACHE */
+        db->gc_step_sec_addr = sec_addr;
+        db->gc_step_kv_addr = sec_addr + SECTOR_HDR_DATA_SIZE;
+    }
+
+    kv.addr.start = db->gc_step_kv_addr;
+    /* collect one KV at least, so it always makes progress */
+    do {
+        read_kv(db, &kv);
+        if (kv.crc_is_ok && (kv.status == FDB_KV_WRITE || kv.status == FDB_KV_PRE_DELETE)) {
+            /* the reserved empty sector is NOT used, it's kept for the foreground GC */
+            if (alloc_kv(db, &alloc_sector, kv.len) == FAILED_ADDR) {
+                FDB_DEBUG("No space for GC step now, the foreground GC will collect the sector.\n");
+                db->gc_request = gc_request;
+                return false;
+            }
+            /* move the KV to new space */
+            if (move_kv(db, &kv) != FDB_NO_ERR) {
+                FDB_INFO("Error: Moved the KV (%.*s) for GC step failed.\n", kv.name_len, kv.name);
+                return true;
+            }
+            moved_size += kv.len;
+        }
+        db->gc_step_kv_addr = kv.addr.start = get_next_kv_addr(db, &sector, &kv);
+    } while (kv.addr.start != FAILED_ADDR && moved_size < budget);
+
+    if (db->gc_step_kv_addr == FAILED_ADDR) {
+        /* all KV has been moved */
+        format_sector(db, db->gc_step_sec_addr, SECTOR_NOT_COMBINED);
+        update_oldest_addr(db, &sector);
+        FDB_DEBUG("Collect a sector @0x%08" PRIX32 " by GC step\n", db->gc_step_sec_addr);
+        db->gc_step_sec_addr = FAILED_ADDR;
+        sec_addr = FAILED_ADDR;
+        sector_iterator(db, &sector, FDB_SECTOR_STORE_UNUSED, &sec_addr, NULL, gc_step_check_cb, false);
+        return sec_addr != FAILED_ADDR;
+    }
+
+    return true;
+}
+
+/**
+ * Run an incremental GC step. It moves the KV of one dirty sector until the moved size reaches the budget,
+ * and formats the sector when all KV has been moved. It's suggest to call it in an idle task, so the foreground KV
+ * setting only waits on GC when the empty sector is not enough.
+ *
+ * @note At least one KV will be collected, even the budget is 0. The reserved empty sector is NOT used by the GC step.
+ *
+ * @param db database object
+ * @param budget the max moved KV size (bytes) in this step
+ *
+ * @return true: there are still dirty sectors to be collected, false: no dirty sector, or no space to move the KV now
+ *         (the foreground GC will collect it when the empty sector is not enough)
+ */
+bool fdb_kvdb_gc_step(fdb_kvdb_t db, size_t budget)
+{
+    bool result;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: KV (%s) isn't initialize OK.\n", db_name(db));
+        return false;
+    }
+
+    /* lock the KV cache */
+    db_lock(db);
+
+    result = gc_step(db, budget);
+
+    /* unlock the KV cache */
+    db_unlock(db);
+
+    return result;
+}
+
+
+/* the KV data staging buffer, the small writes are merged into one aligned flash write */
+struct kv_stage_buf {
+    uint32_t buf[FDB_KV_STAGE_BUF_SIZE / 4];
+    uint32_t addr;                               /**< flash address of the buffer start */
+    size_t used;
+};
+
+/*
+ * Append the data and the erased padding bytes (align_size - size) to the staging buffer.
+ * The full buffer will be written to flash without sync. The large data will be written directly.
+ */
+static fdb_err_t stage_kv_data(fdb_kvdb_t db, struct kv_stage_buf *stage, const void *data, size_t size, size_t align_size)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    const uint8_t *src = data;
+    size_t copy_size;
+
+    while (result == FDB_NO_ERR && align_size) {
+        if (stage->used == 0 && size >= sizeof(stage->buf)) {
+            copy_size = FDB_WG_ALIGN_DOWN(size);
+            result = _fdb_flash_write((fdb_db_t)db, stage->addr, (uint32_t *)src, copy_size, false);
+            stage->addr += copy_size;
+        } else {
+            if (size) {
+                copy_size = size < sizeof(stage->buf) - stage->used ? size : sizeof(stage->buf) - stage->used;
+                memcpy((uint8_t *)stage->buf + stage->used, src, copy_size);
+            } else {
+                copy_size = align_size < sizeof(stage->buf) - stage->used ? align_size : sizeof(stage->buf) - stage->used;
+                memset((uint8_t *)stage->buf + stage->used, FDB_BYTE_ERASED, copy_size);
+            }
+            stage->used += copy_size;
+            if (stage->used == sizeof(stage->buf)) {
+                result = _fdb_flash_write((fdb_db_t)db, stage->addr, stage->buf, stage->used, false);
+                stage->addr += stage->used;
+                stage->used = 0;
+            }
+        }
+        if (size) {
+            src += copy_size;
+            size -= copy_size;
+        }
+        align_size -= copy_size;
+    }
+
+    return result;
+}
+
+/*
+ * Write the KV header, name and value to flash. The KV status will be kept in FDB_KV_PRE_WRITE,
+ * so the caller MUST change it to FDB_KV_WRITE after that.
+ */
+static fdb_err_t write_kv_blob(fdb_kvdb_t db, uint32_t kv_addr, kv_hdr_data_t kv_hdr, const char *key, const void *value)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    size_t align_remain;
+    uint8_t ff = FDB_BYTE_ERASED;
+
+    /* start calculate CRC32 */
+    kv_hdr->crc32 = 0;
+    /* CRC32(header.name_len + header.value_len + name + value), using sizeof(uint32_t) for compatible V1.x */
+    kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, &kv_hdr->name_len, sizeof(uint32_t));
+    kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, &kv_hdr->value_len, sizeof(uint32_t));
+    kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, key, kv_hdr->name_len);
+    align_remain = FDB_WG_ALIGN(kv_hdr->name_len) - kv_hdr->name_len;
+    while (align_remain--) {
+        kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, &ff, 1);
+    }
+    kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, value, kv_hdr->value_len);
+    align_remain = FDB_WG_ALIGN(kv_hdr->value_len) - kv_hdr->value_len;
+    while (align_remain--) {
+        kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, &ff, 1);
+    }
+    /* write the status will by write granularity */
+    result = _fdb_write_status((fdb_db_t)db, kv_addr, kv_hdr->status_table, FDB_KV_STATUS_NUM, FDB_KV_PRE_WRITE, false);
+    /* write other header data, key name and value as one aligned stream */
+    if (result == FDB_NO_ERR) {
+        struct kv_stage_buf stage;
+
+        stage.addr = kv_addr + KV_MAGIC_OFFSET;
+        stage.used = 0;
+        result = stage_kv_data(db, &stage, &kv_hdr->magic, sizeof(struct kv_hdr_data) - KV_MAGIC_OFFSET,
+                KV_HDR_DATA_SIZE - KV_MAGIC_OFFSET);
+        if (result == FDB_NO_ERR) {
+            result = stage_kv_data(db, &stage, key, kv_hdr->name_len, FDB_WG_ALIGN(kv_hdr->name_len));
+        }
+        if (result == FDB_NO_ERR) {
+            result = stage_kv_data(db, &stage, value, kv_hdr->value_len, FDB_WG_ALIGN(kv_hdr->value_len));
+        }
+        if (result == FDB_NO_ERR && stage.used) {
+            result = _fdb_flash_write((fdb_db_t)db, stage.addr, stage.buf, stage.used, false);
+        }
+    }
+#ifdef FDB_KV_GC_COST_BENEFIT
+    /* the failed KV will be changed to error header after reboot */
+    update_sector_usage(db, kv_addr, kv_hdr->len, result == FDB_NO_ERR ? FDB_KV_WRITE : FDB_KV_ERR_HDR);
+#endif
+
+    return result;
+}
+
+/*
+ * Make the new KV visible for the KV index, cache, sector summary and miss cache.
+ */
+static void update_kv_lookup(fdb_kvdb_t db, const char *key, size_t name_len, uint32_t kv_addr)
+{
+#if defined(FDB_KV_USING_INDEX)
+    update_kv_index(db, key, name_len, kv_addr);
+#elif defined(FDB_KV_USING_CACHE)
+    update_kv_cache(db, key, name_len, kv_addr);
+#endif
+#ifdef FDB_KV_USING_SECTOR_SUMMARY
+    update_sector_summary(db, FDB_ALIGN_DOWN(kv_addr, db_sec_size(db)), fdb_calc_crc32(0, key, name_len));
+#endif
+#ifdef FDB_KV_USING_MISS_CACHE
+    remove_kv_miss_cache(db, key, name_len, fdb_calc_crc32(0, key, name_len));
+#endif
+}
+
+static void make_kv_hdr(kv_hdr_data_t kv_hdr, const char *key, size_t len)
+{
+    memset(kv_hdr, FDB_BYTE_ERASED, sizeof(struct kv_hdr_data));
+    kv_hdr->magic = KV_MAGIC_WORD;
+    kv_hdr->name_len = strlen(key);
+    kv_hdr->value_len = len;
+    kv_hdr->len = KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv_hdr->name_len) + FDB_WG_ALIGN(kv_hdr->value_len);
+}
+
+static fdb_err_t create_kv_blob(fdb_kvdb_t db, kv_sec_info_t sector, const char *key, const void *value, size_t len)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    struct kv_hdr_data kv_hdr;
+    bool is_full = false;
+    uint32_t kv_addr = sector->empty_kv;
+
+    if (strlen(key) > FDB_KV_NAME_MAX) {
+        FDB_INFO("Error: The KV name length is more than %d\n", FDB_KV_NAME_MAX);
+        return FDB_KV_NAME_ERR;
+    }
+
+    make_kv_hdr(&kv_hdr, key, len);
+
+    if (kv_hdr.len > db_sec_size(db) - SECTOR_HDR_DATA_SIZE) {
+        FDB_INFO("Error: The KV size is too big\n");
+        return FDB_SAVED_FULL;
+    }
+
+    if (kv_addr != FAILED_ADDR || (kv_addr = new_kv(db, sector, kv_hdr.len)) != FAILED_ADDR) {
+        /* update the sector status */
+        if (result == FDB_NO_ERR) {
+            result = update_sec_status(db, sector, kv_hdr.len, &is_full);
+        }
+        /* write KV header, name and value */
+        if (result == FDB_NO_ERR) {
+            result = write_kv_blob(db, kv_addr, &kv_hdr, key, value);
+        }
+        if (result == FDB_NO_ERR) {
+#ifdef FDB_KV_USING_CACHE
+            if (!is_full) {
+                update_sector_empty_addr_cache(db, sector->addr, kv_addr + kv_hdr.len);
+            }
+#endif /* FDB_KV_USING_CACHE */
+            update_kv_lookup(db, key, kv_hdr.name_len, kv_addr);
+        }
+        /* change the KV status to KV_WRITE */
+        if (result == FDB_NO_ERR) {
+            result = _fdb_write_status((fdb_db_t) db, kv_addr, kv_hdr.status_table, FDB_KV_STATUS_NUM, FDB_KV_WRITE,
+                    true);
+        }
+        /* trigger GC collect when current sector is full */
+        if (result == FDB_NO_ERR && is_full) {
+            FDB_DEBUG("Trigger a GC check after created KV.\n");
+            db->gc_request = true;
+        }
+    } else {
+        result = FDB_SAVED_FULL;
+    }
+
+    return result;
+}
+
+/**
+ * Delete an KV.
+ *
+ * @param db database object
+ * @param key KV name
+ *
+ * @return result
+ */
+fdb_err_t fdb_kv_del(fdb_kvdb_t db, const char *key)
+{
+    fdb_err_t result = FDB_NO_ERR;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: KV (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+
+    /* lock the KV cache */
+    db_lock(db);
+
+#ifdef FDB_KV_USING_WRITE_BUF
+    result = set_kv_to_write_buf(db, key, NULL, 0);
+    check_write_buf_timeout(db);
+#else
+    result = del_kv(db, key, NULL, true);
+#endif
+
+    /* unlock the KV cache */
+    db_unlock(db);
+
+    return result;
+}
+
+static fdb_err_t set_kv(fdb_kvdb_t db, const char *key, const void *value_buf, size_t buf_len)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    bool kv_is_found = false;
+
+    if (value_buf == NULL) {
+        result = del_kv(db, key, NULL, true);
+    } else {
+        /* make sure the flash has enough space */
+        if (new_kv_ex(db, &db->cur_sector, strlen(key), buf_len) == FAILED_ADDR) {
+            return FDB_SAVED_FULL;
+        }
+        kv_is_found = find_kv(db, key, &db->cur_kv);
+        /* prepare to delete the old KV */
+        if (kv_is_found) {
+            result = del_kv(db, key, &db->cur_kv, false);
+        }
+        /* create the new KV */
+        if (result == FDB_NO_ERR) {
+            result = create_kv_blob(db, &db->cur_sector, key, value_buf, buf_len);
+        }
+        /* delete the old KV */
+        if (kv_is_found && result == FDB_NO_ERR) {
+            result = del_kv(db, key, &db->cur_kv, true);
+        }
+        /* process the GC after set KV */
+        if (db->gc_request) {
+            gc_collect_by_free_size(db, KV_HDR_DATA_SIZE + FDB_WG_ALIGN(strlen(key)) + FDB_WG_ALIGN(buf_len));
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Set a blob KV. If it blob value is NULL, delete it.
+ * If not find it in flash, then create it.
+ *
+ * @param db database object
+ * @param key KV name
+ * @param blob blob object
+ *
+ * @return result
+ */
+fdb_err_t fdb_kv_set_blob(fdb_kvdb_t db, const char *key, fdb_blob_t blob)
+{
+    fdb_err_t result = FDB_NO_ERR;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: KV (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+
+    /* lock the KV cache */
+    db_lock(db);
+
+#ifdef FDB_KV_USING_WRITE_BUF
+    result = set_kv_to_write_buf(db, key, blob->buf, blob->size);
+    check_write_buf_timeout(db);
+#else
+    result = set_kv(db, key, blob->buf, blob->size);
+#endif
+
+    /* unlock the KV cache */
+    db_unlock(db);
+
+    return result;
+}
+
+/*
+ * Finish the committed KV batch. All old KVs will be deleted, then the batch KVs status will be changed
+ * to FDB_KV_WRITE. It's idempotent, so it can be resumed when the batch commit KV is found on load.
+ */
+static fdb_err_t finish_kv_batch(fdb_kvdb_t db, fdb_kv_t batch_kv)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    uint8_t status_table[KV_STATUS_TABLE_SIZE];
+    uint32_t range[2], addr;
+    struct fdb_kv kv, old_kv;
+
+    if (batch_kv->value_len != sizeof(range)) {
+        FDB_INFO("Error: The KV batch commit data has an error.\n");
+        return del_kv(db, NULL, batch_kv, true);
+    }
+    _fdb_flash_read((fdb_db_t)db, batch_kv->addr.value, range, sizeof(range));
+    for (addr = range[0]; result == FDB_NO_ERR && addr < range[1]; addr += kv.len) {
+        kv.addr.start = addr;
+        if (read_kv(db, &kv) != FDB_NO_ERR) {
+            /* the KV length is unknown when read KV header failed */
+            if (kv.len == KV_HDR_DATA_SIZE) {
+                break;
+            }
+            continue;
+        }
+        if (kv.status != FDB_KV_PRE_WRITE) {
+            /* already finished */
+            continue;
+        }
+        /* the batch KVs are invisible now, so the found KV is the old one */
+        if (find_kv(db, kv.name, &old_kv)) {
+            result = del_kv_ex(db, kv.name, &old_kv, true, false);
+        }
+        if (result == FDB_NO_ERR) {
+            result = _fdb_write_status((fdb_db_t)db, addr, status_table, FDB_KV_STATUS_NUM, FDB_KV_WRITE, false);
+        }
+        if (result == FDB_NO_ERR) {
+            update_kv_lookup(db, kv.name, kv.name_len, addr);
+        }
+    }
+    /* the old KVs maybe in other files, so sync them before the batch is published by deleting the commit KV */
+    if (result == FDB_NO_ERR) {
+        result = _fdb_flash_sync((fdb_db_t)db);
+    }
+    /* the batch is finished, so delete the commit KV */
+    if (result == FDB_NO_ERR) {
+        result = del_kv(db, NULL, batch_kv, true);
     }
 
-    db->gc_request = false;
-}
-
-/*
- * The GC will be triggered on the following scene:
- * 1. alloc an KV when the flash not has enough space
- * 2. write an KV then the flash not has enough space
- */
-static void gc_collect(fdb_kvdb_t db)
-{
-    gc_collect_by_free_size(db, db_max_size(db));
+    return result;
 }
 
-
-static fdb_err_t create_kv_blob(fdb_kvdb_t db, kv_sec_info_t sector, const char *key, const void *value, size_t len)
+static fdb_err_t set_kv_batch(fdb_kvdb_t db, const char *keys[], struct fdb_blob blobs[], size_t num)
 {
     fdb_err_t result = FDB_NO_ERR;
     struct kv_hdr_data kv_hdr;
+    struct fdb_kv batch_kv;
+    kv_sec_info_t sector = &db->cur_sector;
     bool is_full = false;
-    uint32_t kv_addr = sector->empty_kv;
+    uint32_t range[2], kv_addr;
+    size_t i, batch_len = KV_HDR_DATA_SIZE + FDB_WG_ALIGN(sizeof(BATCH_KV_NAME) - 1) + FDB_WG_ALIGN(sizeof(range));
 
-    if (strlen(key) > FDB_KV_NAME_MAX) {
-        FDB_INFO("Error: The KV name length is more than %d\n", FDB_KV_NAME_MAX);
-        return FDB_KV_NAME_ERR;
+    for (i = 0; i < num; i++) {
+        if (strlen(keys[i]) > FDB_KV_NAME_MAX) {
+            FDB_INFO("Error: The KV name length is more than %d\n", FDB_KV_NAME_MAX);
+            return FDB_KV_NAME_ERR;
+        }
+        if (blobs[i].buf == NULL) {
+            FDB_INFO("Error: The KV (%s) value is NULL, the KV batch can't delete KV.\n", keys[i]);
+            return FDB_WRITE_ERR;
+        }
+        batch_len += KV_HDR_DATA_SIZE + FDB_WG_ALIGN(strlen(keys[i])) + FDB_WG_ALIGN(blobs[i].size);
     }
-
-    memset(&kv_hdr, FDB_BYTE_ERASED, sizeof(struct kv_hdr_data));
-    kv_hdr.magic = KV_MAGIC_WORD;
-    kv_hdr.name_len = strlen(key);
-    kv_hdr.value_len = len;
-    kv_hdr.len = KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv_hdr.name_len) + FDB_WG_ALIGN(kv_hdr.value_len);
-
-    if (kv_hdr.len > db_sec_size(db) - SECTOR_HDR_DATA_SIZE) {
-        FDB_INFO("Error: The KV size is too big\n");
+    /* all KVs of the batch MUST be saved in one sector */
+    if (batch_len > db_sec_size(db) - SECTOR_HDR_DATA_SIZE) {
+        FDB_INFO("Error: The KV batch size is too big\n");
         return FDB_SAVED_FULL;
     }
-
-    if (kv_addr != FAILED_ADDR || (kv_addr = new_kv(db, sector, kv_hdr.len)) != FAILED_ADDR) {
-        size_t align_remain;
-        /* update the sector status */
-        if (result == FDB_NO_ERR) {
-            result = update_sec_status(db, sector, kv_hdr.len, &is_full);
-        }
-        if (result == FDB_NO_ERR) {
-            uint8_t ff = FDB_BYTE_ERASED;
-            /* start calculate CRC32 */
-            kv_hdr.crc32 = 0;
-            /* CRC32(header.name_len + header.value_len + name + value), using sizeof(uint32_t) for compatible V1.x */
-            kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, &kv_hdr.name_len, sizeof(uint32_t));
-            kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, &kv_hdr.value_len, sizeof(uint32_t));
-            kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, key, kv_hdr.name_len);
-            align_remain = FDB_WG_ALIGN(kv_hdr.name_len) - kv_hdr.name_len;
-            while (align_remain--) {
-                kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, &ff, 1);
-            }
-            kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, value, kv_hdr.value_len);
-            align_remain = FDB_WG_ALIGN(kv_hdr.value_len) - kv_hdr.value_len;
-            while (align_remain--) {
-                kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, &ff, 1);
-            }
-            /* write KV header data */
-            result = write_kv_hdr(db, kv_addr, &kv_hdr);
-        }
-        /* write key name */
-        if (result == FDB_NO_ERR) {
-            result = _fdb_flash_write_align((fdb_db_t)db, kv_addr + KV_HDR_DATA_SIZE, (uint32_t *) key, kv_hdr.name_len);
-
+    if ((kv_addr = new_kv(db, sector, batch_len)) == FAILED_ADDR) {
+        return FDB_SAVED_FULL;
+    }
+    result = update_sec_status(db, sector, batch_len, &is_full);
+    /* write all KVs back to back, they are invisible before the commit KV is written */
+    range[0] = kv_addr;
+    for (i = 0; result == FDB_NO_ERR && i < num; i++) {
+        make_kv_hdr(&kv_hdr, keys[i], blobs[i].size);
+        result = write_kv_blob(db, kv_addr, &kv_hdr, keys[i], blobs[i].buf);
+        kv_addr += kv_hdr.len;
+    }
+    range[1] = kv_addr;
+    /* write the commit KV, this is the commit point of the whole batch */
+    if (result == FDB_NO_ERR) {
+        make_kv_hdr(&kv_hdr, BATCH_KV_NAME, sizeof(range));
+        result = write_kv_blob(db, kv_addr, &kv_hdr, BATCH_KV_NAME, range);
+    }
+    if (result == FDB_NO_ERR) {
+        result = _fdb_write_status((fdb_db_t) db, kv_addr, kv_hdr.status_table, FDB_KV_STATUS_NUM, FDB_KV_WRITE, true);
+    }
+    if (result == FDB_NO_ERR) {
 #ifdef FDB_KV_USING_CACHE
-            if (!is_full) {
-                update_sector_empty_addr_cache(db, sector->addr,
-                        kv_addr + KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv_hdr.name_len) + FDB_WG_ALIGN(kv_hdr.value_len));
-            }
-            update_kv_cache(db, key, kv_hdr.name_len, kv_addr);
-#endif /* FDB_KV_USING_CACHE */
-        }
-        /* write value */
-        if (result == FDB_NO_ERR) {
-            result = _fdb_flash_write_align((fdb_db_t)db, kv_addr + KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv_hdr.name_len), value,
-                    kv_hdr.value_len);
-        }
-        /* change the KV status to KV_WRITE */
-        if (result == FDB_NO_ERR) {
-            result = _fdb_write_status((fdb_db_t) db, kv_addr, kv_hdr.status_table, FDB_KV_STATUS_NUM, FDB_KV_WRITE,
-                    true);
+        if (!is_full) {
+            update_sector_empty_addr_cache(db, sector->addr, kv_addr + kv_hdr.len);
         }
-        /* trigger GC collect when current sector is full */
-        if (result == FDB_NO_ERR && is_full) {
-            FDB_DEBUG("Trigger a GC check after created KV.\n");
-            db->gc_request = true;
-        }
-    } else {
-        result = FDB_SAVED_FULL;
+#endif /* FDB_KV_USING_CACHE */
+        batch_kv.addr.start = kv_addr;
+        result = read_kv(db, &batch_kv);
+    }
+    if (result == FDB_NO_ERR) {
+        result = finish_kv_batch(db, &batch_kv);
+    }
+    /* trigger GC collect when current sector is full */
+    if (result == FDB_NO_ERR && is_full) {
+        FDB_DEBUG("Trigger a GC check after created KV batch.\n");
+        db->gc_request = true;
+    }
+    /* process the GC after set KV batch */
+    if (db->gc_request) {
+        gc_collect_by_free_size(db, batch_len);
     }
 
     return result;
 }
 
 /**
- * Delete an KV.
+ * Set some blob KVs in one batch. The KVs in batch will be all changed or nothing changed after power off.
+ * All KVs of the batch will be written in one sector, so the total size MUST less than the sector size.
  *
  * @param db database object
- * @param key KV name
+ * @param keys KV name array
+ * @param blobs blob object array, the blob value can NOT be NULL
+ * @param num the number of KVs in batch
  *
  * @return result
  */
-fdb_err_t fdb_kv_del(fdb_kvdb_t db, const char *key)
+fdb_err_t fdb_kv_set_batch(fdb_kvdb_t db, const char *keys[], struct fdb_blob blobs[], size_t num)
 {
     fdb_err_t result = FDB_NO_ERR;
 
@@ -1284,7 +2519,15 @@ fdb_err_t fdb_kv_del(fdb_kvdb_t db, const char *key)
     /* lock the KV cache */
     db_lock(db);
 
-    result = del_kv(db, key, NULL, true);
+#ifdef FDB_KV_USING_WRITE_BUF
+    /* keep the KVs order, the buffered KVs are older than the batch */
+    result = flush_write_buf(db, NULL);
+    if (result == FDB_NO_ERR) {
+        result = set_kv_batch(db, keys, blobs, num);
+    }
+#else
+    result = set_kv_batch(db, keys, blobs, num);
+#endif
 
     /* unlock the KV cache */
     db_unlock(db);
@@ -1292,51 +2535,146 @@ fdb_err_t fdb_kv_del(fdb_kvdb_t db, const char *key)
     return result;
 }
 
-static fdb_err_t set_kv(fdb_kvdb_t db, const char *key, const void *value_buf, size_t buf_len)
+#ifdef FDB_KV_USING_WRITE_BUF
+/* the max KV number of each batch when flushing the write buffer */
+#define KV_WRITE_BUF_BATCH_NUM                   8
+
+/*
+ * Flush the KV in write buffer to flash, all KVs will be flushed when the key is NULL.
+ * The buffered KVs are saved by batch, so the KVs in one batch are changed all or nothing after power off.
+ */
+static fdb_err_t flush_write_buf(fdb_kvdb_t db, const char *key)
 {
     fdb_err_t result = FDB_NO_ERR;
-    bool kv_is_found = false;
+    struct kv_write_buf_node node;
+    const char *keys[KV_WRITE_BUF_BATCH_NUM];
+    struct fdb_blob blobs[KV_WRITE_BUF_BATCH_NUM];
+    size_t offset, num = 0, i;
+
+    if (key) {
+        int32_t found = find_kv_in_write_buf(db, key, &node);
+        if (found >= 0) {
+            result = set_kv(db, key, db->write_buf + found + sizeof(struct kv_write_buf_node) + node.name_len + 1,
+                    node.value_len);
+            if (result == FDB_NO_ERR) {
+                remove_kv_in_write_buf(db, found, &node);
+            }
+        }
+        return result;
+    }
 
-    if (value_buf == NULL) {
-        result = del_kv(db, key, NULL, true);
-    } else {
-        /* make sure the flash has enough space */
-        if (new_kv_ex(db, &db->cur_sector, strlen(key), buf_len) == FAILED_ADDR) {
-            return FDB_SAVED_FULL;
+    for (offset = 0; result == FDB_NO_ERR && offset < db->write_buf_used;) {
+        memcpy(&node, db->write_buf + offset, sizeof(struct kv_write_buf_node));
+        keys[num] = (const char *)db->write_buf + offset + sizeof(struct kv_write_buf_node);
+        blobs[num].buf = (void *)(keys[num] + node.name_len + 1);
+        blobs[num].size = node.value_len;
+        num++;
+        offset += KV_WRITE_BUF_NODE_SIZE(node.name_len, node.value_len);
+        if (num == KV_WRITE_BUF_BATCH_NUM || offset >= db->write_buf_used) {
+            result = set_kv_batch(db, keys, blobs, num);
+            if (result == FDB_SAVED_FULL) {
+                /* the batch is too big for one sector, save the KVs one by one */
+                for (i = 0, result = FDB_NO_ERR; result == FDB_NO_ERR && i < num; i++) {
+                    result = set_kv(db, keys[i], blobs[i].buf, blobs[i].size);
+                }
+            }
+            num = 0;
         }
-        kv_is_found = find_kv(db, key, &db->cur_kv);
-        /* prepare to delete the old KV */
-        if (kv_is_found) {
-            result = del_kv(db, key, &db->cur_kv, false);
+    }
+    if (result == FDB_NO_ERR) {
+        db->write_buf_used = 0;
+    }
+
+    return result;
+}
+
+static fdb_err_t set_kv_to_write_buf(fdb_kvdb_t db, const char *key, const void *value_buf, size_t buf_len)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    struct kv_write_buf_node node;
+    int32_t offset = find_kv_in_write_buf(db, key, &node);
+    size_t node_size, old_node_size = 0;
+
+    if (value_buf == NULL) {
+        if (offset >= 0) {
+            remove_kv_in_write_buf(db, offset, &node);
         }
-        /* create the new KV */
-        if (result == FDB_NO_ERR) {
-            result = create_kv_blob(db, &db->cur_sector, key, value_buf, buf_len);
+        result = del_kv(db, key, NULL, true);
+        /* the KV was only saved in write buffer */
+        if (result == FDB_KV_NAME_ERR && offset >= 0) {
+            result = FDB_NO_ERR;
         }
-        /* delete the old KV */
-        if (kv_is_found && result == FDB_NO_ERR) {
-            result = del_kv(db, key, &db->cur_kv, true);
+        return result;
+    }
+
+    if (strlen(key) > FDB_KV_NAME_MAX) {
+        FDB_INFO("Error: The KV name length is more than %d\n", FDB_KV_NAME_MAX);
+        return FDB_KV_NAME_ERR;
+    }
+
+    if (offset >= 0) {
+        old_node_size = KV_WRITE_BUF_NODE_SIZE(node.name_len, node.value_len);
+    }
+    node_size = KV_WRITE_BUF_NODE_SIZE(strlen(key), buf_len);
+    if (node_size > FDB_KV_WRITE_BUF_SIZE) {
+        /* the KV is too big, save it to flash directly */
+        if (offset >= 0) {
+            remove_kv_in_write_buf(db, offset, &node);
         }
-        /* process the GC after set KV */
-        if (db->gc_request) {
-            gc_collect_by_free_size(db, KV_HDR_DATA_SIZE + FDB_WG_ALIGN(strlen(key)) + FDB_WG_ALIGN(buf_len));
+        return set_kv(db, key, value_buf, buf_len);
+    } else if (db->write_buf_used - old_node_size + node_size > FDB_KV_WRITE_BUF_SIZE) {
+        /* the write buffer is full */
+        result = flush_write_buf(db, NULL);
+        if (result != FDB_NO_ERR) {
+            return result;
         }
-    }
+    } else if (offset >= 0) {
+        /* the old value in write buffer is useless */
+        remove_kv_in_write_buf(db, offset, &node);
+    }
+
+    if (db->write_buf_used == 0) {
+        db->write_buf_time = db->get_time ? db->get_time() : 0;
+    }
+    node.name_len = strlen(key);
+    node.value_len = buf_len;
+    memcpy(db->write_buf + db->write_buf_used, &node, sizeof(struct kv_write_buf_node));
+    memcpy(db->write_buf + db->write_buf_used + sizeof(struct kv_write_buf_node), key, node.name_len + 1);
+    memcpy(db->write_buf + db->write_buf_used + sizeof(struct kv_write_buf_node) + node.name_len + 1, value_buf, buf_len);
+    db->write_buf_used += node_size;
+#ifdef FDB_KV_USING_MISS_CACHE
+    /* the KV is created in write buffer */
+    remove_kv_miss_cache(db, key, node.name_len, fdb_calc_crc32(0, key, node.name_len));
+#endif
 
     return result;
 }
 
+/*
+ * Flush the write buffer when the first buffered KV is timeout.
+ */
+static void check_write_buf_timeout(fdb_kvdb_t db)
+{
+    if (db->write_buf_used && db->flush_timeout && db->get_time
+            && db->get_time() - db->write_buf_time >= db->flush_timeout) {
+        flush_write_buf(db, NULL);
+    }
+}
+#endif /* FDB_KV_USING_WRITE_BUF */
+
 /**
- * Set a blob KV. If it blob value is NULL, delete it.
- * If not find it in flash, then create it.
+ * Flush the KV write buffer to flash.
+ *
+ * @note When the write buffer (FDB_KV_WRITE_BUF_SIZE) is enabled, the KV which is set by fdb_kv_set_blob or fdb_kv_set
+ * is saved in RAM first. It will be lost after power off until this function is called, the write buffer is full
+ * or a set/get/del API is called after the flush timeout (FDB_KVDB_CTRL_SET_FLUSH_TIMEOUT). The timeout is NOT
+ * checked while the database is idle, so call this function in a periodic timer to bound the durability window.
  *
  * @param db database object
- * @param key KV name
- * @param blob blob object
  *
  * @return result
  */
-fdb_err_t fdb_kv_set_blob(fdb_kvdb_t db, const char *key, fdb_blob_t blob)
+fdb_err_t fdb_kvdb_flush(fdb_kvdb_t db)
 {
     fdb_err_t result = FDB_NO_ERR;
 
@@ -1345,13 +2683,15 @@ fdb_err_t fdb_kv_set_blob(fdb_kvdb_t db, const char *key, fdb_blob_t blob)
         return FDB_INIT_FAILED;
     }
 
+#ifdef FDB_KV_USING_WRITE_BUF
     /* lock the KV cache */
     db_lock(db);
 
-    result = set_kv(db, key, blob->buf, blob->size);
+    result = flush_write_buf(db, NULL);
 
     /* unlock the KV cache */
     db_unlock(db);
+#endif
 
     return result;
 }
@@ -1392,11 +2732,23 @@ fdb_err_t fdb_kv_set_default(fdb_kvdb_t db)
     /* lock the KV cache */
     db_lock(db);
 
-#ifdef FDB_KV_USING_CACHE
+#if defined(FDB_KV_USING_INDEX)
+    clean_kv_index(db);
+#elif defined(FDB_KV_USING_CACHE)
     for (i = 0; i < FDB_KV_CACHE_TABLE_SIZE; i++) {
         db->kv_cache_table[i].addr = FDB_DATA_UNUSED;
     }
-#endif /* FDB_KV_USING_CACHE */
+#endif /* FDB_KV_USING_INDEX */
+
+#ifdef FDB_KV_USING_MISS_CACHE
+    db->kv_miss_cache_num = 0;
+#endif
+
+#ifdef FDB_KV_USING_WRITE_BUF
+    db->write_buf_used = 0;
+#endif
+
+    db->gc_step_sec_addr = FAILED_ADDR;
 
     /* format all sectors */
     for (addr = 0; addr < db_max_size(db); addr += db_sec_size(db)) {
@@ -1496,6 +2848,10 @@ void fdb_kv_print(fdb_kvdb_t db)
     /* lock the KV cache */
     db_lock(db);
 
+#ifdef FDB_KV_USING_WRITE_BUF
+    flush_write_buf(db, NULL);
+#endif
+
     kv_iterator(db, &kv, &using_size, db, print_kv_cb);
 
     FDB_PRINT("\nmode: next generation\n");
@@ -1611,16 +2967,68 @@ static bool check_and_recovery_kv_cb(fdb_kv_t kv, void *arg1, void *arg2)
         /* the KV has not write finish, change the status to error */
         //TODO Draw the state replacement diagram of exception handling
         _fdb_write_status((fdb_db_t)db, kv->addr.start, status_table, FDB_KV_STATUS_NUM, FDB_KV_ERR_HDR, true);
-        return true;
+        /* continue to check the next KV, so the KV index and sector summary will be built completely */
+        return false;
     } else if (kv->crc_is_ok && kv->status == FDB_KV_WRITE) {
-#ifdef FDB_KV_USING_CACHE
+#if defined(FDB_KV_USING_INDEX)
+        /* build the index when first load */
+        update_kv_index(db, kv->name, kv->name_len, kv->addr.start);
+#elif defined(FDB_KV_USING_CACHE)
         /* update the cache when first load. If caching is disabled, this step is not performed */
         update_kv_cache(db, kv->name, kv->name_len, kv->addr.start);
 #endif
+#ifdef FDB_KV_USING_SECTOR_SUMMARY
+        /* build the sector summary when first load */
+        update_sector_summary(db, FDB_ALIGN_DOWN(kv->addr.start, db_sec_size(db)), fdb_calc_crc32(0, kv->name, kv->name_len));
+#endif
+    }
+
+    return false;
+}
+
+#ifdef FDB_KV_USING_SECTOR_TABLE
+/*
+ * Load all sector info to the sector table, the table will be used when all sectors are loaded.
+ */
+static void load_sector_table(fdb_kvdb_t db)
+{
+    uint32_t i, sec_num = SECTOR_NUM;
+
+    db->sector_table_ok = false;
+    if (sec_num > FDB_KV_SECTOR_TABLE_SIZE) {
+        FDB_INFO("Warning: The sector table size (%d) is less than the sector number (%" PRIu32 ").\n",
+                FDB_KV_SECTOR_TABLE_SIZE, sec_num);
+        return;
+    }
+    for (i = 0; i < sec_num; i++) {
+        memset(&db->sector_table[i], 0, sizeof(struct kvdb_sec_info));
+        db->sector_table[i].empty_kv = FAILED_ADDR;
+        read_sector_info(db, i * db_sec_size(db), &db->sector_table[i], true);
+    }
+    /* the sector cache is NOT updated when using the sector table, so clean it to avoid using it after reboot */
+    for (i = 0; i < FDB_SECTOR_CACHE_TABLE_SIZE; i++) {
+        db->sector_cache_table[i].check_ok = false;
+        db->sector_cache_table[i].empty_kv = FAILED_ADDR;
+        db->sector_cache_table[i].addr = FDB_DATA_UNUSED;
+    }
+    db->sector_table_ok = true;
+}
+#endif /* FDB_KV_USING_SECTOR_TABLE */
+
+#ifdef FDB_KV_GC_COST_BENEFIT
+static bool build_sector_usage_cb(fdb_kv_t kv, void *arg1, void *arg2)
+{
+    fdb_kvdb_t db = arg1;
+
+    if (kv->crc_is_ok && (kv->status == FDB_KV_WRITE || kv->status == FDB_KV_PRE_DELETE)) {
+        update_sector_usage(db, kv->addr.start, kv->len, FDB_KV_WRITE);
+    } else {
+        update_sector_usage(db, kv->addr.start, kv->len, FDB_KV_ERR_HDR);
     }
 
     return false;
 }
+#endif /* FDB_KV_GC_COST_BENEFIT */
 
 /**
  * Check and load the flash KV.
@@ -1646,6 +3054,12 @@ static fdb_err_t _fdb_kv_load(fdb_kvdb_t db)
         fdb_kv_set_default(db);
     }
 
+    /* finish the committed KV batch, it MUST before the PRE_WRITE KVs recovery */
+    if (find_kv(db, BATCH_KV_NAME, &kv)) {
+        FDB_INFO("Found an unfinished KV batch. Now will finish it.\n");
+        finish_kv_batch(db, &kv);
+    }
+
     /* check all sector header for recovery GC */
     sector_iterator(db, &sector, FDB_SECTOR_STORE_UNUSED, db, NULL, check_and_recovery_gc_cb, false);
 
@@ -1659,6 +3073,17 @@ __retry:
 
     db->in_recovery_check = false;
 
+#ifdef FDB_KV_USING_SECTOR_TABLE
+    load_sector_table(db);
+#endif
+#ifdef FDB_KV_USING_SECTOR_SUMMARY
+    db->sector_summary_ok = true;
+#endif
+#ifdef FDB_KV_GC_COST_BENEFIT
+    /* build the sector live and dead KV size after recovery, the KV is NOT changed anymore */
+    kv_iterator(db, &kv, db, NULL, build_sector_usage_cb);
+#endif
+
     return result;
 }
 
@@ -1700,6 +3125,27 @@ void fdb_kvdb_control(fdb_kvdb_t db, int cmd, void *arg)
         db->parent.unlock = (void (*)(fdb_db_t db)) arg;
 #if !defined(__ARMCC_VERSION) && defined(__GNUC__)
 #pragma GCC diagnostic pop
+#endif
+        break;
+    case FDB_KVDB_CTRL_SET_GET_TIME:
+#ifdef FDB_KV_USING_WRITE_BUF
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+        db->get_time = (fdb_get_time) arg;
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+#else
+        FDB_INFO("Error: set get time function Failed. Please defined the FDB_KV_WRITE_BUF_SIZE macro.");
+#endif
+        break;
+    case FDB_KVDB_CTRL_SET_FLUSH_TIMEOUT:
+#ifdef FDB_KV_USING_WRITE_BUF
+        db->flush_timeout = *(fdb_time_t *) arg;
+#else
+        FDB_INFO("Error: set flush timeout Failed. Please defined the FDB_KV_WRITE_BUF_SIZE macro.");
 #endif
         break;
     case FDB_KVDB_CTRL_SET_FILE_MODE:
@@ -1723,6 +3169,30 @@ void fdb_kvdb_control(fdb_kvdb_t db, int cmd, void *arg)
         FDB_ASSERT(db->parent.init_ok == false);
         db->parent.not_formatable = *(bool *)arg;
         break;
+    case FDB_KVDB_CTRL_SET_DURABILITY:
+#ifdef FDB_USING_FILE_MODE
+        _fdb_set_durability((fdb_db_t)db, *(fdb_durability_t *)arg);
+#else
+        FDB_INFO("Error: set durability Failed. Please defined the FDB_USING_FILE_MODE macro.");
+#endif
+        break;
+    case FDB_KVDB_CTRL_SET_GROUP_SYNC:
+#ifdef FDB_USING_FILE_MODE
+        db->parent.group_sync = *(uint32_t *)arg;
+#else
+        FDB_INFO("Error: set group sync Failed. Please defined the FDB_USING_FILE_MODE macro.");
+#endif
+        break;
+    case FDB_KVDB_CTRL_SET_BLOCK_CACHE:
+        /* this change MUST before database initialization */
+        FDB_ASSERT(db->parent.init_ok == false);
+#ifdef FDB_USING_BLOCK_CACHE
+        db->parent.cache_blocks = (struct fdb_cache_block *)((struct fdb_block_cache_mem *)arg)->buf;
+        db->parent.cache_block_num = ((struct fdb_block_cache_mem *)arg)->size / sizeof(struct fdb_cache_block);
+#else
+        FDB_INFO("Error: set block cache Failed. Please defined the FDB_BLOCK_CACHE_BLOCK_SIZE macro.");
+#endif
+        break;
     }
 }
 
@@ -1760,6 +3230,10 @@ fdb_err_t fdb_kvdb_init(fdb_kvdb_t db, const char *name, const char *path, struc
 
     db->gc_request = false;
     db->in_recovery_check = false;
+    db->gc_step_sec_addr = FAILED_ADDR;
+#ifdef FDB_KV_USING_SECTOR_TABLE
+    db->sector_table_ok = false;
+#endif
     if (default_kv) {
         db->default_kvs = *default_kv;
     } else {
@@ -1786,11 +3260,31 @@ fdb_err_t fdb_kvdb_init(fdb_kvdb_t db, const char *name, const char *path, struc
         db->sector_cache_table[i].empty_kv = FAILED_ADDR;
         db->sector_cache_table[i].addr = FDB_DATA_UNUSED;
     }
+#ifndef FDB_KV_USING_INDEX
     for (i = 0; i < FDB_KV_CACHE_TABLE_SIZE; i++) {
         db->kv_cache_table[i].addr = FDB_DATA_UNUSED;
     }
+#endif
 #endif /* FDB_KV_USING_CACHE */
 
+#ifdef FDB_KV_USING_INDEX
+    clean_kv_index(db);
+#endif
+
+#ifdef FDB_KV_USING_SECTOR_SUMMARY
+    memset(db->sector_summary_table, 0, sizeof(db->sector_summary_table));
+    db->sector_summary_ok = false;
+#endif
+
+#ifdef FDB_KV_USING_MISS_CACHE
+    db->kv_miss_cache_num = 0;
+    db->kv_miss_cache_next = 0;
+#endif
+
+#ifdef FDB_KV_USING_WRITE_BUF
+    db->write_buf_used = 0;
+#endif
+
     FDB_DEBUG("KVDB size is %" PRIu32 " bytes.\n", db_max_size(db));
     db_unlock(db);
 
@@ -1822,6 +3316,12 @@ __exit:
  */
 fdb_err_t fdb_kvdb_deinit(fdb_kvdb_t db)
 {
+#ifdef FDB_KV_USING_WRITE_BUF
+    if (db_init_ok(db)) {
+        fdb_kvdb_flush(db);
+    }
+#endif
+
     _fdb_deinit((fdb_db_t) db);
 
     return FDB_NO_ERR;
@@ -1837,6 +3337,13 @@ fdb_err_t fdb_kvdb_deinit(fdb_kvdb_t db)
  */
 fdb_kv_iterator_t fdb_kv_iterator_init(fdb_kvdb_t db, fdb_kv_iterator_t itr)
 {
+#ifdef FDB_KV_USING_WRITE_BUF
+    /* the iterator only reads the KVs in flash */
+    if (db_init_ok(db)) {
+        fdb_kvdb_flush(db);
+    }
+#endif
+
     itr->curr_kv.addr.start = 0;
 
     /* If iterator statistics is needed */
@@ -1849,15 +3356,7 @@ fdb_kv_iterator_t fdb_kv_iterator_init(fdb_kvdb_t db, fdb_kv_iterator_t itr)
     return itr;
 }
 
-/**
- * The KV database iterator.
- *
- * @param db database object
- * @param itr the iterator structure
- *
- * @return false if iteration is ended, true if iteration is not ended.
- */
-bool fdb_kv_iterate(fdb_kvdb_t db, fdb_kv_iterator_t itr)
+static bool kv_iterate(fdb_kvdb_t db, fdb_kv_iterator_t itr)
 {
     struct kvdb_sec_info sector;
     fdb_kv_t kv = &(itr->curr_kv);
@@ -1895,6 +3394,26 @@ bool fdb_kv_iterate(fdb_kvdb_t db, fdb_kv_iterator_t itr)
     return false;
 }
 
+/**
+ * The KV database iterator.
+ *
+ * @param db database object
+ * @param itr the iterator structure
+ *
+ * @return false if iteration is ended, true if iteration is not ended.
+ */
+bool fdb_kv_iterate(fdb_kvdb_t db, fdb_kv_iterator_t itr)
+{
+    bool result;
+
+    /* the caches of the database are shared with other threads, so lock it in each step */
+    db_lock(db);
+    result = kv_iterate(db, itr);
+    db_unlock(db);
+
+    return result;
+}
+
 /**
  * The database inergrity check
  *
@@ -70,6 +70,14 @@
 /* the next address is get failed */
 #define FAILED_ADDR                              0xFFFFFFFF
 
+#if defined(FDB_TSDB_USING_AGGR_SUMMARY) && !defined(FDB_TSDB_USING_SECTOR_INDEX)
+#error "The TSDB aggregate summary needs the sector index, please configure the FDB_TSDB_SECTOR_INDEX_TABLE_SIZE"
+#endif
+
+#if defined(FDB_TSDB_USING_STATUS_COUNT) && !defined(FDB_TSDB_USING_SECTOR_INDEX)
+#error "The TSDB status count needs the sector index, please configure the FDB_TSDB_SECTOR_INDEX_TABLE_SIZE"
+#endif
+
 #define db_name(db)                              (((fdb_db_t)db)->name)
 #define db_init_ok(db)                           (((fdb_db_t)db)->init_ok)
 #define db_sec_size(db)                          (((fdb_db_t)db)->sec_size)
@@ -135,6 +143,7 @@ typedef struct log_idx_data *log_idx_data_t;
 struct query_count_args {
     fdb_tsl_status_t status;
     size_t count;
+    bool all_status;
 };
 
 struct check_sec_hdr_cb_args {
@@ -174,6 +183,42 @@ static fdb_err_t read_tsl(fdb_tsdb_t db, fdb_tsl_t tsl)
     return FDB_NO_ERR;
 }
 
+/*
+ * Add the TSL log value to the aggregate result. Only count the TSL when there is no value get function.
+ */
+static void aggr_add_log(fdb_tsdb_t db, fdb_tsl_aggr_t aggr, const void *log, size_t len)
+{
+    double value;
+
+    if (db->get_value == NULL) {
+        aggr->count++;
+    } else if (db->get_value(log, len, &value)) {
+        if (aggr->count == 0 || value < aggr->min) {
+            aggr->min = value;
+        }
+        if (aggr->count == 0 || value > aggr->max) {
+            aggr->max = value;
+        }
+        aggr->sum += value;
+        aggr->count++;
+    }
+}
+
+static void aggr_merge(fdb_tsl_aggr_t aggr, fdb_tsl_aggr_t src)
+{
+    if (src->count == 0) {
+        return;
+    }
+    if (aggr->count == 0 || src->min < aggr->min) {
+        aggr->min = src->min;
+    }
+    if (aggr->count == 0 || src->max > aggr->max) {
+        aggr->max = src->max;
+    }
+    aggr->sum += src->sum;
+    aggr->count += src->count;
+}
+
 static uint32_t get_next_sector_addr(fdb_tsdb_t db, tsdb_sec_info_t pre_sec, uint32_t traversed_len)
 {
     if (traversed_len + db_sec_size(db) <= db_max_size(db)) {
@@ -280,8 +325,11 @@ static fdb_err_t read_sector_info(fdb_tsdb_t db, uint32_t addr, tsdb_sec_info_t
     if (sector->status == FDB_SECTOR_STORE_USING && traversal) {
         struct fdb_tsl tsl;
 
+        /* the timestamp of TSL is always more than 0, so 0 means there is no TSL in this sector */
+        sector->end_time = 0;
         tsl.addr.index = sector->empty_idx;
-        while (read_tsl(db, &tsl) == FDB_NO_ERR) {
+        /* the next TSL index is overlapped with the TSL data when the remain space is NOT enough */
+        while (sector->remain >= LOG_IDX_DATA_SIZE && read_tsl(db, &tsl) == FDB_NO_ERR) {
             if (tsl.status == FDB_TSL_UNUSED) {
                 break;
             }
@@ -292,7 +340,7 @@ static fdb_err_t read_sector_info(fdb_tsdb_t db, uint32_t addr, tsdb_sec_info_t
             sector->empty_idx += LOG_IDX_DATA_SIZE;
             sector->empty_data -= FDB_WG_ALIGN(tsl.log_len);
             tsl.addr.index += LOG_IDX_DATA_SIZE;
-            if (sector->remain > LOG_IDX_DATA_SIZE + FDB_WG_ALIGN(tsl.log_len)) {
+            if (sector->remain >= LOG_IDX_DATA_SIZE + FDB_WG_ALIGN(tsl.log_len)) {
                 sector->remain -= (LOG_IDX_DATA_SIZE + FDB_WG_ALIGN(tsl.log_len));
             } else {
                 FDB_INFO("Error: this TSL (0x%08" PRIX32 ") size (%" PRIu32 ") is out of bound.\n", tsl.addr.index, tsl.log_len);
@@ -306,6 +354,96 @@ static fdb_err_t read_sector_info(fdb_tsdb_t db, uint32_t addr, tsdb_sec_info_t
     return result;
 }
 
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+static tsdb_sec_index_t get_sector_index(fdb_tsdb_t db, uint32_t sec_addr)
+{
+    uint32_t index = sec_addr / db_sec_size(db);
+
+    if (index < FDB_TSDB_SECTOR_INDEX_TABLE_SIZE) {
+        return &db->sector_index_table[index];
+    }
+
+    return NULL;
+}
+
+static void update_sector_index(fdb_tsdb_t db, tsdb_sec_info_t sector)
+{
+    tsdb_sec_index_t index = get_sector_index(db, sector->addr);
+
+    if (index) {
+        index->status = sector->status;
+        index->start_time = sector->start_time;
+        index->end_time = sector->end_time;
+        index->end_idx = sector->end_idx;
+#ifdef FDB_TSDB_USING_AGGR_SUMMARY
+        if (sector->status == FDB_SECTOR_STORE_EMPTY) {
+            memset(&index->aggr, 0, sizeof(index->aggr));
+            index->aggr_ok = true;
+        }
+#endif
+#ifdef FDB_TSDB_USING_STATUS_COUNT
+        if (sector->status == FDB_SECTOR_STORE_EMPTY) {
+            memset(index->status_count, 0, sizeof(index->status_count));
+            index->status_count_ok = true;
+        }
+#endif
+    }
+}
+
+/*
+ * Find the start sector of the TSL query by time in the sector index by binary search.
+ * The sectors from the oldest to the current using sector are sorted by time.
+ *
+ * @return the start sector address, FAILED_ADDR: there is no matched sector
+ */
+static uint32_t search_start_sec_addr(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, uint32_t *traversed_len)
+{
+    tsdb_sec_index_t index;
+    uint32_t cur_pos, result = FAILED_ADDR;
+    int32_t low = 0, high, mid;
+
+    /* the sector position is counted from the oldest sector */
+    cur_pos = (db->cur_sec.addr + db_max_size(db) - db_oldest_addr(db)) % db_max_size(db) / db_sec_size(db);
+    high = cur_pos;
+    if (db->cur_sec.status != FDB_SECTOR_STORE_USING && db->cur_sec.status != FDB_SECTOR_STORE_FULL) {
+        high--;
+    }
+    while (low <= high) {
+        mid = (low + high) / 2;
+        index = get_sector_index(db, (db_oldest_addr(db) + mid * db_sec_size(db)) % db_max_size(db));
+        if (index->status != FDB_SECTOR_STORE_USING && index->status != FDB_SECTOR_STORE_FULL) {
+            /* the sector index is NOT continuous, search from the first sector */
+            *traversed_len = 0;
+            return from <= to ? db_oldest_addr(db) : db->cur_sec.addr;
+        }
+        if (from <= to) {
+            /* the first sector which end time is NOT less than the starting timestamp */
+            if (index->end_time >= from) {
+                result = mid;
+                high = mid - 1;
+            } else {
+                low = mid + 1;
+            }
+        } else {
+            /* the last sector which start time is NOT more than the starting timestamp */
+            if (index->start_time <= from) {
+                result = mid;
+                low = mid + 1;
+            } else {
+                high = mid - 1;
+            }
+        }
+    }
+
+    if (result == FAILED_ADDR) {
+        return FAILED_ADDR;
+    }
+    *traversed_len = (from <= to ? result : cur_pos - result) * db_sec_size(db);
+
+    return (db_oldest_addr(db) + result * db_sec_size(db)) % db_max_size(db);
+}
+#endif /* FDB_TSDB_USING_SECTOR_INDEX */
+
 static fdb_err_t format_sector(fdb_tsdb_t db, uint32_t addr)
 {
     fdb_err_t result = FDB_NO_ERR;
@@ -321,6 +459,23 @@ static fdb_err_t format_sector(fdb_tsdb_t db, uint32_t addr)
         memset(sec_hdr.magic, FDB_BYTE_ERASED, TSL_UINT32_ALIGN_SIZE);
         memcpy(sec_hdr.magic, &magic, sizeof(uint32_t));
         FLASH_WRITE(db, addr + SECTOR_MAGIC_OFFSET, &sec_hdr.magic, TSL_UINT32_ALIGN_SIZE, true);
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+        {
+            tsdb_sec_index_t index = get_sector_index(db, addr);
+
+            if (index) {
+                index->status = FDB_SECTOR_STORE_EMPTY;
+#ifdef FDB_TSDB_USING_AGGR_SUMMARY
+                memset(&index->aggr, 0, sizeof(index->aggr));
+                index->aggr_ok = true;
+#endif
+#ifdef FDB_TSDB_USING_STATUS_COUNT
+                memset(index->status_count, 0, sizeof(index->status_count));
+                index->status_count_ok = true;
+#endif
+            }
+        }
+#endif
     }
 
     return result;
@@ -347,7 +502,7 @@ static void sector_iterator(fdb_tsdb_t db, tsdb_sec_info_t sector, fdb_sector_st
     } while ((sec_addr = get_next_sector_addr(db, sector, traversed_len)) != FAILED_ADDR);
 }
 
-static fdb_err_t write_tsl(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t time)
+static fdb_err_t write_tsl(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t time, bool sync)
 {
     fdb_err_t result = FDB_NO_ERR;
     struct log_idx_data idx;
@@ -371,7 +526,7 @@ static fdb_err_t write_tsl(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t time)
         return result;
     }
     /* write the status will by write granularity */
-    _FDB_WRITE_STATUS(db, idx_addr, idx.status_table, FDB_TSL_STATUS_NUM, FDB_TSL_WRITE, true);
+    _FDB_WRITE_STATUS(db, idx_addr, idx.status_table, FDB_TSL_STATUS_NUM, FDB_TSL_WRITE, sync);
 
     return result;
 }
@@ -408,6 +563,9 @@ static fdb_err_t update_sec_status(fdb_tsdb_t db, tsdb_sec_info_t sector, fdb_bl
         /* change current sector to full */
         _FDB_WRITE_STATUS(db, cur_sec_addr, status, FDB_SECTOR_STORE_STATUS_NUM, FDB_SECTOR_STORE_FULL, true);
         sector->status = FDB_SECTOR_STORE_FULL;
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+        update_sector_index(db, sector);
+#endif
         /* calculate next sector address */
         if (sector->addr + db_sec_size(db) < db_max_size(db)) {
             new_sec_addr = sector->addr + db_sec_size(db);
@@ -448,7 +606,7 @@ static fdb_err_t update_sec_status(fdb_tsdb_t db, tsdb_sec_info_t sector, fdb_bl
     return result;
 }
 
-static fdb_err_t tsl_append(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t *timestamp)
+static fdb_err_t tsl_append(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t *timestamp, bool sync)
 {
     fdb_err_t result = FDB_NO_ERR;
     fdb_time_t cur_time = timestamp == NULL ? db->get_time() : *timestamp;
@@ -481,7 +639,7 @@ static fdb_err_t tsl_append(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t *timestam
         return result;
     }
     /* write the TSL node */
-    result = write_tsl(db, blob, cur_time);
+    result = write_tsl(db, blob, cur_time, sync);
     if (result != FDB_NO_ERR) {
         FDB_INFO("Error: write tsl failed (%d)", result);
         return result;
@@ -494,6 +652,27 @@ static fdb_err_t tsl_append(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t *timestam
     db->cur_sec.empty_data -= FDB_WG_ALIGN(blob->size);
     db->cur_sec.remain -= LOG_IDX_DATA_SIZE + FDB_WG_ALIGN(blob->size);
     db->last_time = cur_time;
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+    update_sector_index(db, &db->cur_sec);
+#endif
+#ifdef FDB_TSDB_USING_AGGR_SUMMARY
+    {
+        tsdb_sec_index_t index = get_sector_index(db, db->cur_sec.addr);
+
+        if (index && index->aggr_ok) {
+            aggr_add_log(db, &index->aggr, blob->buf, blob->size < FDB_TSDB_AGGR_LOG_SIZE ? blob->size : FDB_TSDB_AGGR_LOG_SIZE);
+        }
+    }
+#endif
+#ifdef FDB_TSDB_USING_STATUS_COUNT
+    {
+        tsdb_sec_index_t index = get_sector_index(db, db->cur_sec.addr);
+
+        if (index && index->status_count_ok) {
+            index->status_count[FDB_TSL_WRITE]++;
+        }
+    }
+#endif
 
     return result;
 }
@@ -516,7 +695,7 @@ fdb_err_t fdb_tsl_append(fdb_tsdb_t db, fdb_blob_t blob)
     }
 
     db_lock(db);
-    result = tsl_append(db, blob, NULL);
+    result = tsl_append(db, blob, NULL, true);
     db_unlock(db);
 
     return result;
@@ -540,7 +719,53 @@ fdb_err_t fdb_tsl_append_with_ts(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t time
     }
 
     db_lock(db);
-    result = tsl_append(db, blob, &timestamp);
+    result = tsl_append(db, blob, &timestamp, true);
+    db_unlock(db);
+
+    return result;
+}
+
+/**
+ * Append some new logs to TSDB. The logs are written one by one, and all of them are synced once after the last
+ * log is written. When a log is failed to append, the logs before it are saved, and the remaining are dropped.
+ *
+ * @param db database object
+ * @param blobs the log blob data array
+ * @param timestamps the timestamp array of each log, the current time will be used when it's NULL
+ * @param num the log number
+ *
+ * @return result
+ */
+fdb_err_t fdb_tsl_append_batch(fdb_tsdb_t db, struct fdb_blob blobs[], const fdb_time_t timestamps[], size_t num)
+{
+    fdb_err_t result = FDB_NO_ERR, sync_result;
+    fdb_time_t timestamp;
+    size_t i;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+
+    db_lock(db);
+    for (i = 0; i < num; i++) {
+        if (timestamps) {
+            timestamp = timestamps[i];
+            result = tsl_append(db, &blobs[i], &timestamp, false);
+        } else {
+            result = tsl_append(db, &blobs[i], NULL, false);
+        }
+        if (result != FDB_NO_ERR) {
+            break;
+        }
+    }
+    /* publish all appended logs by one sync */
+    if (i > 0) {
+        sync_result = _fdb_flash_sync((fdb_db_t)db);
+        if (result == FDB_NO_ERR) {
+            result = sync_result;
+        }
+    }
     db_unlock(db);
 
     return result;
@@ -667,11 +892,9 @@ static int search_start_tsl_addr(fdb_tsdb_t db, int start, int end, fdb_time_t f
 
         if (start > end) {
             if (from > to) {
-                tsl.addr.index = start;
-                read_tsl(db, &tsl);
-                if (tsl.time > from) {
-                    start -= LOG_IDX_DATA_SIZE;
-                }
+                /* the start is the first TSL which is later than the starting timestamp, and it may be out of
+                 * the sector end index, so the last TSL which is earlier than the starting timestamp is before it */
+                start -= LOG_IDX_DATA_SIZE;
             }
             break;
         }
@@ -721,6 +944,15 @@ void fdb_tsl_iter_by_time(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl
 
     sec_addr = start_addr;
     db_lock(db);
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+    if (db->sector_index_ok) {
+        /* jump to the start sector directly */
+        sec_addr = search_start_sec_addr(db, from, to, &traversed_len);
+        if (sec_addr == FAILED_ADDR) {
+            goto __exit;
+        }
+    }
+#endif
     /* search all sectors */
     do {
         traversed_len += db_sec_size(db);
@@ -768,40 +1000,471 @@ __exit:
     db_unlock(db);
 }
 
-static bool query_count_cb(fdb_tsl_t tsl, void *arg)
+/*
+ * Read the sector info without traversal, the current using sector info is got from RAM.
+ */
+static fdb_err_t load_sector_info(fdb_tsdb_t db, uint32_t addr, tsdb_sec_info_t sector)
 {
-    struct query_count_args *args = arg;
+    if (addr == db->cur_sec.addr) {
+        *sector = db->cur_sec;
+        return FDB_NO_ERR;
+    }
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+    if (db->sector_index_ok) {
+        tsdb_sec_index_t index = get_sector_index(db, addr);
+
+        /* the full sector info will NOT be changed until it's formatted */
+        if (index->status == FDB_SECTOR_STORE_FULL) {
+            sector->addr = addr;
+            sector->check_ok = true;
+            sector->status = FDB_SECTOR_STORE_FULL;
+            sector->start_time = index->start_time;
+            sector->end_time = index->end_time;
+            sector->end_idx = index->end_idx;
+            return FDB_NO_ERR;
+        }
+    }
+#endif
 
-    if (tsl->status == args->status) {
-        args->count++;
+    return read_sector_info(db, addr, sector, false);
+}
+
+/*
+ * Find the first TSL index address which timestamp is NOT earlier than the time.
+ *
+ * @return the TSL index address, it's the next empty TSL index when all TSL are earlier than the time
+ */
+static uint32_t search_tsl_addr_by_time(fdb_tsdb_t db, fdb_time_t time)
+{
+    struct tsdb_sec_info sector;
+    uint32_t sec_addr = db_oldest_addr(db), traversed_len = 0;
+
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+    if (db->sector_index_ok) {
+        sec_addr = search_start_sec_addr(db, time, time, &traversed_len);
+        if (sec_addr == FAILED_ADDR) {
+            return db->cur_sec.empty_idx;
+        }
     }
+#endif
 
-    return false;
+    do {
+        traversed_len += db_sec_size(db);
+        if (load_sector_info(db, sec_addr, &sector) != FDB_NO_ERR) {
+            continue;
+        }
+        if (sector.status == FDB_SECTOR_STORE_USING || sector.status == FDB_SECTOR_STORE_FULL) {
+            if (sector.end_time >= time) {
+                return search_start_tsl_addr(db, sector.addr + SECTOR_HDR_DATA_SIZE, sector.end_idx, time, time);
+            }
+        } else if (sector.status == FDB_SECTOR_STORE_EMPTY) {
+            break;
+        }
+    } while ((sec_addr = get_next_sector_addr(db, &sector, traversed_len)) != FAILED_ADDR);
+
+    return db->cur_sec.empty_idx;
+}
+
+/*
+ * Get the cursor TSL index address, it's searched again by the cursor time when the sectors are erased.
+ */
+static uint32_t get_cursor_addr(fdb_tsdb_t db, fdb_tsl_cursor_t cursor)
+{
+    if (cursor->idx_addr == FAILED_ADDR || cursor->generation != db->parent.generation) {
+        cursor->idx_addr = search_tsl_addr_by_time(db, cursor->time);
+        cursor->generation = db->parent.generation;
+    }
+
+    return cursor->idx_addr;
 }
 
 /**
- * Query some TSL's count by timestamp and status.
+ * Initialize the TSDB cursor, the cursor is at the oldest TSL.
+ *
+ * @param db database object
+ * @param cursor the cursor structure to be initialized
+ *
+ * @return pointer to the cursor initialized.
+ */
+fdb_tsl_cursor_t fdb_tsl_cursor_init(fdb_tsdb_t db, fdb_tsl_cursor_t cursor)
+{
+    cursor->curr_tsl.status = FDB_TSL_UNUSED;
+    cursor->time = 0;
+    cursor->idx_addr = FAILED_ADDR;
+    cursor->generation = 0;
+
+    return cursor;
+}
+
+/**
+ * Move the TSDB cursor to the timestamp. The next TSL of the cursor is the first TSL which timestamp is NOT earlier
+ * than it, and the previous TSL is the last TSL which timestamp is earlier than it.
+ * The saved cursor time can be resumed by this function, such as after the database is reinitialized.
+ *
+ * @param db database object
+ * @param cursor the cursor structure
+ * @param time the timestamp
+ */
+void fdb_tsl_cursor_seek(fdb_tsdb_t db, fdb_tsl_cursor_t cursor, fdb_time_t time)
+{
+    cursor->time = time;
+    /* the TSL index address will be searched at next step */
+    cursor->idx_addr = FAILED_ADDR;
+}
+
+/**
+ * Get the next TSL of the TSDB cursor, the database is only locked in this step.
+ * The cursor->curr_tsl is the got TSL.
+ *
+ * @param db database object
+ * @param cursor the cursor structure
+ *
+ * @return false if there is no next TSL, true if the next TSL is got.
+ */
+bool fdb_tsl_cursor_next(fdb_tsdb_t db, fdb_tsl_cursor_t cursor)
+{
+    struct tsdb_sec_info sector;
+    fdb_tsl_t tsl = &cursor->curr_tsl;
+    uint32_t addr, sec_addr;
+    bool found = false;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+        return false;
+    }
+
+    db_lock(db);
+    addr = get_cursor_addr(db, cursor);
+    while (load_sector_info(db, FDB_ALIGN_DOWN(addr, db_sec_size(db)), &sector) == FDB_NO_ERR) {
+        if (sector.status == FDB_SECTOR_STORE_USING) {
+            if (addr >= sector.empty_idx) {
+                /* no new TSL */
+                break;
+            }
+        } else if (sector.status == FDB_SECTOR_STORE_FULL) {
+            if (addr > sector.end_idx) {
+                /* the next sector */
+                sec_addr = sector.addr + db_sec_size(db) < db_max_size(db) ? sector.addr + db_sec_size(db) : 0;
+                if (sec_addr == db_oldest_addr(db)) {
+                    break;
+                }
+                addr = sec_addr + SECTOR_HDR_DATA_SIZE;
+                continue;
+            }
+        } else {
+            break;
+        }
+        tsl->addr.index = addr;
+        read_tsl(db, tsl);
+        addr += LOG_IDX_DATA_SIZE;
+        /* skip the TSL which is NOT written finished or earlier than the cursor */
+        if (tsl->status != FDB_TSL_UNUSED && tsl->status != FDB_TSL_PRE_WRITE && tsl->time >= cursor->time) {
+            cursor->time = tsl->time + 1;
+            found = true;
+            break;
+        }
+    }
+    cursor->idx_addr = addr;
+    db_unlock(db);
+
+    return found;
+}
+
+/**
+ * Get the previous TSL of the TSDB cursor, the database is only locked in this step.
+ * The cursor->curr_tsl is the got TSL.
+ *
+ * @param db database object
+ * @param cursor the cursor structure
+ *
+ * @return false if there is no previous TSL, true if the previous TSL is got.
+ */
+bool fdb_tsl_cursor_prev(fdb_tsdb_t db, fdb_tsl_cursor_t cursor)
+{
+    struct tsdb_sec_info sector;
+    fdb_tsl_t tsl = &cursor->curr_tsl;
+    uint32_t addr, sec_addr;
+    bool found = false;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+        return false;
+    }
+
+    db_lock(db);
+    addr = get_cursor_addr(db, cursor);
+    while (load_sector_info(db, FDB_ALIGN_DOWN(addr, db_sec_size(db)), &sector) == FDB_NO_ERR) {
+        if (sector.status == FDB_SECTOR_STORE_USING) {
+            if (addr > sector.empty_idx) {
+                addr = sector.empty_idx;
+            }
+        } else if (sector.status == FDB_SECTOR_STORE_FULL) {
+            if (addr > sector.end_idx + LOG_IDX_DATA_SIZE) {
+                addr = sector.end_idx + LOG_IDX_DATA_SIZE;
+            }
+        } else {
+            /* the sector has no TSL */
+            addr = sector.addr + SECTOR_HDR_DATA_SIZE;
+        }
+        if (addr < sector.addr + SECTOR_HDR_DATA_SIZE + LOG_IDX_DATA_SIZE) {
+            /* the previous sector */
+            if (sector.addr == db_oldest_addr(db)) {
+                addr = sector.addr + SECTOR_HDR_DATA_SIZE;
+                break;
+            }
+            sec_addr = sector.addr >= db_sec_size(db) ? sector.addr - db_sec_size(db) : db_max_size(db) - db_sec_size(db);
+            if (load_sector_info(db, sec_addr, &sector) != FDB_NO_ERR
+                    || (sector.status != FDB_SECTOR_STORE_USING && sector.status != FDB_SECTOR_STORE_FULL)) {
+                break;
+            }
+            addr = sector.status == FDB_SECTOR_STORE_USING ? sector.empty_idx : sector.end_idx + LOG_IDX_DATA_SIZE;
+            continue;
+        }
+        addr -= LOG_IDX_DATA_SIZE;
+        tsl->addr.index = addr;
+        read_tsl(db, tsl);
+        /* skip the TSL which is NOT written finished */
+        if (tsl->status != FDB_TSL_UNUSED && tsl->status != FDB_TSL_PRE_WRITE) {
+            cursor->time = tsl->time;
+            found = true;
+            break;
+        }
+    }
+    cursor->idx_addr = addr;
+    db_unlock(db);
+
+    return found;
+}
+
+/*
+ * Iterate all sectors which have the TSL in the time range, the starting timestamp MUST NOT be more than the ending.
+ */
+static void sector_iter_by_time(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to,
+        void (*callback)(fdb_tsdb_t db, tsdb_sec_info_t sector, fdb_time_t from, fdb_time_t to, void *arg), void *arg)
+{
+    struct tsdb_sec_info sector;
+    uint32_t sec_addr = db_oldest_addr(db), traversed_len = 0;
+
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+    if (db->sector_index_ok) {
+        sec_addr = search_start_sec_addr(db, from, to, &traversed_len);
+        if (sec_addr == FAILED_ADDR) {
+            return;
+        }
+    }
+#endif
+
+    do {
+        traversed_len += db_sec_size(db);
+        if (load_sector_info(db, sec_addr, &sector) != FDB_NO_ERR) {
+            continue;
+        }
+        if (sector.status == FDB_SECTOR_STORE_EMPTY
+                || (sector.status == FDB_SECTOR_STORE_USING && sector.empty_idx == sector.addr + SECTOR_HDR_DATA_SIZE)) {
+            /* no more TSL */
+            break;
+        }
+        if (sector.status == FDB_SECTOR_STORE_USING || sector.status == FDB_SECTOR_STORE_FULL) {
+            if (sector.start_time > to) {
+                break;
+            }
+            if (sector.end_time >= from) {
+                callback(db, &sector, from, to, arg);
+            }
+        }
+    } while ((sec_addr = get_next_sector_addr(db, &sector, traversed_len)) != FAILED_ADDR);
+}
+
+/*
+ * Aggregate the TSL in the time range of the sector. The sector summary is used and built when the whole sector is
+ * in the time range.
+ */
+static void aggr_sector(fdb_tsdb_t db, tsdb_sec_info_t sector, fdb_time_t from, fdb_time_t to, void *arg)
+{
+    fdb_tsl_aggr_t aggr = arg;
+    struct fdb_tsl tsl;
+    struct fdb_tsl_aggr sec_aggr = { 0 };
+    uint32_t log[(FDB_TSDB_AGGR_LOG_SIZE + 3) / 4];
+    size_t len;
+#ifdef FDB_TSDB_USING_AGGR_SUMMARY
+    tsdb_sec_index_t index = get_sector_index(db, sector->addr);
+    bool whole = sector->start_time >= from && sector->end_time <= to;
+
+    if (index && whole && index->aggr_ok) {
+        aggr_merge(aggr, &index->aggr);
+        return;
+    }
+#endif
+
+    if (sector->start_time < from) {
+        tsl.addr.index = search_start_tsl_addr(db, sector->addr + SECTOR_HDR_DATA_SIZE, sector->end_idx, from, to);
+    } else {
+        tsl.addr.index = sector->addr + SECTOR_HDR_DATA_SIZE;
+    }
+    for (; tsl.addr.index <= sector->end_idx; tsl.addr.index += LOG_IDX_DATA_SIZE) {
+        read_tsl(db, &tsl);
+        if (tsl.status == FDB_TSL_UNUSED || tsl.status == FDB_TSL_PRE_WRITE || tsl.status == FDB_TSL_DELETED) {
+            continue;
+        }
+        if (tsl.time > to) {
+            break;
+        }
+        len = tsl.log_len < FDB_TSDB_AGGR_LOG_SIZE ? tsl.log_len : FDB_TSDB_AGGR_LOG_SIZE;
+        if (db->get_value) {
+            _fdb_flash_read((fdb_db_t)db, tsl.addr.log, log, len);
+        }
+        aggr_add_log(db, &sec_aggr, log, len);
+    }
+    aggr_merge(aggr, &sec_aggr);
+
+#ifdef FDB_TSDB_USING_AGGR_SUMMARY
+    if (index && whole) {
+        index->aggr = sec_aggr;
+        index->aggr_ok = true;
+    }
+#endif
+}
+
+/**
+ * Aggregate the value (count, min, max and sum) of the TSL in the time range, the deleted TSL is NOT aggregated.
+ * The value is got by the FDB_TSDB_CTRL_SET_AGGR_VALUE function, only count the TSL when the function is NOT set.
  *
  * @param db database object
  * @param from starting timestamp
  * @param to ending timestamp
- * @param status status
+ * @param aggr the aggregate result
+ *
+ * @return result
  */
-size_t fdb_tsl_query_count(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl_status_t status)
+fdb_err_t fdb_tsl_aggregate(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl_aggr_t aggr)
 {
-    struct query_count_args arg = { FDB_TSL_UNUSED, 0 };
+    fdb_time_t time;
+
+    memset(aggr, 0, sizeof(struct fdb_tsl_aggr));
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+
+    if (from > to) {
+        time = from;
+        from = to;
+        to = time;
+    }
+
+    db_lock(db);
+    sector_iter_by_time(db, from, to, aggr_sector, aggr);
+    db_unlock(db);
+
+    return FDB_NO_ERR;
+}
+
+/*
+ * Count the TSL in the time range of the sector. The TSL index is continuous, so the count of all status is calculated
+ * by the first and last TSL index address in the time range.
+ */
+static void count_sector(fdb_tsdb_t db, tsdb_sec_info_t sector, fdb_time_t from, fdb_time_t to, void *arg)
+{
+    struct query_count_args *args = arg;
+    struct fdb_tsl tsl;
+    int start = sector->addr + SECTOR_HDR_DATA_SIZE, end = sector->end_idx;
+#ifdef FDB_TSDB_USING_STATUS_COUNT
+    tsdb_sec_index_t index = get_sector_index(db, sector->addr);
+    bool whole = sector->start_time >= from && sector->end_time <= to;
+    uint32_t status_count[FDB_TSL_STATUS_NUM] = { 0 };
+
+    /* the TSL which is NOT written finished has no timestamp, so it's only counted by scanning */
+    if (!args->all_status && args->status != FDB_TSL_UNUSED && args->status != FDB_TSL_PRE_WRITE && index && whole
+            && index->status_count_ok) {
+        args->count += index->status_count[args->status];
+        return;
+    }
+#endif
+
+    if (sector->start_time < from) {
+        start = search_start_tsl_addr(db, start, end, from, to);
+    }
+    if (args->all_status) {
+        if (sector->end_time > to) {
+            /* the last TSL which timestamp is NOT more than the ending timestamp */
+            end = search_start_tsl_addr(db, start, end, to, to - 1);
+        }
+        if (end >= start) {
+            args->count += (end - start) / LOG_IDX_DATA_SIZE + 1;
+        }
+        return;
+    }
+
+    for (tsl.addr.index = start; tsl.addr.index <= sector->end_idx; tsl.addr.index += LOG_IDX_DATA_SIZE) {
+        read_tsl(db, &tsl);
+        if (tsl.status != FDB_TSL_UNUSED && tsl.status != FDB_TSL_PRE_WRITE && tsl.time > to) {
+            break;
+        }
+        if (tsl.status == args->status && tsl.time >= from) {
+            args->count++;
+        }
+#ifdef FDB_TSDB_USING_STATUS_COUNT
+        status_count[tsl.status]++;
+#endif
+    }
 
-    arg.status = status;
+#ifdef FDB_TSDB_USING_STATUS_COUNT
+    if (index && whole) {
+        memcpy(index->status_count, status_count, sizeof(status_count));
+        index->status_count_ok = true;
+    }
+#endif
+}
+
+static size_t query_count(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl_status_t status, bool all_status)
+{
+    struct query_count_args arg = { status, 0, all_status };
+    fdb_time_t time;
 
     if (!db_init_ok(db)) {
         FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
         return 0;
     }
 
-    fdb_tsl_iter_by_time(db, from, to, query_count_cb, &arg);
+    if (from > to) {
+        time = from;
+        from = to;
+        to = time;
+    }
+
+    db_lock(db);
+    sector_iter_by_time(db, from, to, count_sector, &arg);
+    db_unlock(db);
 
     return arg.count;
+}
 
+/**
+ * Query some TSL's count by timestamp and status.
+ * The sector which is fully in the time range is NOT read when FDB_TSDB_USING_STATUS_COUNT is enabled.
+ *
+ * @param db database object
+ * @param from starting timestamp
+ * @param to ending timestamp
+ * @param status status
+ */
+size_t fdb_tsl_query_count(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl_status_t status)
+{
+    return query_count(db, from, to, status, false);
+}
+
+/**
+ * Query the TSL's count of all status by timestamp, including the TSL which is NOT written finished.
+ * Only the TSL index of the first and last sector in the time range is searched.
+ *
+ * @param db database object
+ * @param from starting timestamp
+ * @param to ending timestamp
+ */
+size_t fdb_tsl_query_count_all(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to)
+{
+    return query_count(db, from, to, FDB_TSL_UNUSED, true);
 }
 
 /**
@@ -817,9 +1480,38 @@ fdb_err_t fdb_tsl_set_status(fdb_tsdb_t db, fdb_tsl_t tsl, fdb_tsl_status_t stat
 {
     fdb_err_t result = FDB_NO_ERR;
     uint8_t status_table[TSL_STATUS_TABLE_SIZE];
+#if defined(FDB_TSDB_USING_STATUS_COUNT) || defined(FDB_TSDB_USING_AGGR_SUMMARY)
+    tsdb_sec_index_t index = get_sector_index(db, FDB_ALIGN_DOWN(tsl->addr.index, db_sec_size(db)));
+#endif
+#ifdef FDB_TSDB_USING_STATUS_COUNT
+    struct fdb_tsl old_tsl;
+
+    old_tsl.addr.index = tsl->addr.index;
+    if (index && index->status_count_ok) {
+        read_tsl(db, &old_tsl);
+    }
+#endif
 
     /* write the status will by write granularity */
-    _FDB_WRITE_STATUS(db, tsl->addr.index, status_table, FDB_TSL_STATUS_NUM, status, true);
+    result = _fdb_write_status((fdb_db_t)db, tsl->addr.index, status_table, FDB_TSL_STATUS_NUM, status, true);
+#ifdef FDB_TSDB_USING_STATUS_COUNT
+    if (index && index->status_count_ok && status != old_tsl.status) {
+        if (result == FDB_NO_ERR && status > old_tsl.status) {
+            /* move the TSL from the old status count to the new */
+            index->status_count[old_tsl.status]--;
+            index->status_count[status]++;
+        } else {
+            /* the status on flash is unknown, so the status count will be built again */
+            index->status_count_ok = false;
+        }
+    }
+#endif
+#ifdef FDB_TSDB_USING_AGGR_SUMMARY
+    /* the TSL maybe NOT aggregated by the new status, so the sector summary will be built again */
+    if (index) {
+        index->aggr_ok = false;
+    }
+#endif
 
     return result;
 }
@@ -841,11 +1533,51 @@ fdb_blob_t fdb_tsl_to_blob(fdb_tsl_t tsl, fdb_blob_t blob)
     return blob;
 }
 
+/**
+ * Get the TSL data pointer without copying, it's only supported when the storage is directly
+ * addressable, such as the mmap file mode or the FAL XIP flash. It's usually used in the TSL iterator callback.
+ * The pointer is valid until the database generation (fdb_db_generation) is changed.
+ *
+ * @param db database object
+ * @param tsl the TSL object
+ * @param log_len the TSL data length
+ * @param generation the database generation when getting the pointer, it can be NULL
+ *
+ * @return the TSL data pointer, NULL when the TSL has no data or the storage is NOT addressable
+ */
+const void *fdb_tsl_get_ptr(fdb_tsdb_t db, fdb_tsl_t tsl, size_t *log_len, uint32_t *generation)
+{
+    const void *data = NULL;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+        return NULL;
+    }
+
+    if (tsl->status == FDB_TSL_UNUSED || tsl->status == FDB_TSL_PRE_WRITE) {
+        return NULL;
+    }
+
+    data = _fdb_flash_map((fdb_db_t)db, tsl->addr.log, tsl->log_len);
+    if (data) {
+        *log_len = tsl->log_len;
+        if (generation) {
+            *generation = db->parent.generation;
+        }
+    }
+
+    return data;
+}
+
 static bool check_sec_hdr_cb(tsdb_sec_info_t sector, void *arg1, void *arg2)
 {
     struct check_sec_hdr_cb_args *arg = arg1;
     fdb_tsdb_t db = arg->db;
 
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+    update_sector_index(db, sector);
+#endif
+
     if (!sector->check_ok) {
         FDB_INFO("Sector (0x%08" PRIX32 ") header info is incorrect.\n", sector->addr);
         (arg->check_failed) = true;
@@ -978,6 +1710,52 @@ void fdb_tsdb_control(fdb_tsdb_t db, int cmd, void *arg)
         FDB_ASSERT(db->parent.init_ok == false);
         db->parent.not_formatable = *(bool *)arg;
         break;
+    case FDB_TSDB_CTRL_SET_DURABILITY:
+#ifdef FDB_USING_FILE_MODE
+        _fdb_set_durability((fdb_db_t)db, *(fdb_durability_t *)arg);
+#else
+        FDB_INFO("Error: set durability Failed. Please defined the FDB_USING_FILE_MODE macro.");
+#endif
+        break;
+    case FDB_TSDB_CTRL_SET_GROUP_SYNC:
+#ifdef FDB_USING_FILE_MODE
+        db->parent.group_sync = *(uint32_t *)arg;
+#else
+        FDB_INFO("Error: set group sync Failed. Please defined the FDB_USING_FILE_MODE macro.");
+#endif
+        break;
+    case FDB_TSDB_CTRL_SET_BLOCK_CACHE:
+        /* this change MUST before database initialization */
+        FDB_ASSERT(db->parent.init_ok == false);
+#ifdef FDB_USING_BLOCK_CACHE
+        db->parent.cache_blocks = (struct fdb_cache_block *)((struct fdb_block_cache_mem *)arg)->buf;
+        db->parent.cache_block_num = ((struct fdb_block_cache_mem *)arg)->size / sizeof(struct fdb_cache_block);
+#else
+        FDB_INFO("Error: set block cache Failed. Please defined the FDB_BLOCK_CACHE_BLOCK_SIZE macro.");
+#endif
+        break;
+    case FDB_TSDB_CTRL_SET_AGGR_VALUE:
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+        db->get_value = (fdb_tsl_get_value)arg;
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+#ifdef FDB_TSDB_USING_AGGR_SUMMARY
+        {
+            size_t i;
+
+            /* the sector summaries will be built again by the new function */
+            for (i = 0; i < FDB_TSDB_SECTOR_INDEX_TABLE_SIZE; i++) {
+                if (db->sector_index_table[i].status != FDB_SECTOR_STORE_EMPTY) {
+                    db->sector_index_table[i].aggr_ok = false;
+                }
+            }
+        }
+#endif
+        break;
     }
 }
 
@@ -1015,6 +1793,29 @@ fdb_err_t fdb_tsdb_init(fdb_tsdb_t db, const char *name, const char *path, fdb_g
     db->rollover = true;
     db_oldest_addr(db) = FDB_DATA_UNUSED;
     db->cur_sec.addr = FDB_DATA_UNUSED;
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+    db->sector_index_ok = false;
+#endif
+#ifdef FDB_TSDB_USING_AGGR_SUMMARY
+    {
+        size_t i;
+
+        /* the sector summaries are built by the TSL aggregate, except the empty sector */
+        for (i = 0; i < FDB_TSDB_SECTOR_INDEX_TABLE_SIZE; i++) {
+            db->sector_index_table[i].aggr_ok = false;
+        }
+    }
+#endif
+#ifdef FDB_TSDB_USING_STATUS_COUNT
+    {
+        size_t i;
+
+        /* the sector status counts are built by the TSL count query, except the empty sector */
+        for (i = 0; i < FDB_TSDB_SECTOR_INDEX_TABLE_SIZE; i++) {
+            db->sector_index_table[i].status_count_ok = false;
+        }
+    }
+#endif
     /* must less than sector size */
     FDB_ASSERT(max_len < db_sec_size(db));
 
@@ -1054,9 +1855,11 @@ fdb_err_t fdb_tsdb_init(fdb_tsdb_t db, const char *name, const char *path, fdb_g
     /* read the current using sector info */
     read_sector_info(db, db->cur_sec.addr, &db->cur_sec, true);
     /* get last save time */
-    if (db->cur_sec.status == FDB_SECTOR_STORE_USING) {
+    if (db->cur_sec.status == FDB_SECTOR_STORE_USING && db->cur_sec.end_time != 0) {
         db->last_time = db->cur_sec.end_time;
-    } else if (db->cur_sec.status == FDB_SECTOR_STORE_EMPTY && db_oldest_addr(db) != db->cur_sec.addr) {
+    } else if ((db->cur_sec.status == FDB_SECTOR_STORE_EMPTY || db->cur_sec.status == FDB_SECTOR_STORE_USING)
+            && db_oldest_addr(db) != db->cur_sec.addr) {
+        /* the current sector has no TSL (maybe power off after it's changed to using), so get it from previous sector */
         struct tsdb_sec_info sec;
         uint32_t addr = db->cur_sec.addr;
 
@@ -1068,6 +1871,10 @@ fdb_err_t fdb_tsdb_init(fdb_tsdb_t db, const char *name, const char *path, fdb_g
         read_sector_info(db, addr, &sec, false);
         db->last_time = sec.end_time;
     }
+#ifdef FDB_TSDB_USING_SECTOR_INDEX
+    /* all sectors are indexed when the table is large enough */
+    db->sector_index_ok = db_max_size(db) / db_sec_size(db) <= FDB_TSDB_SECTOR_INDEX_TABLE_SIZE;
+#endif
 
     /* unlock the TSDB */
     db_unlock(db);
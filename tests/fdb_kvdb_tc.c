@@ -199,6 +199,14 @@ static void test_fdb_kvdb_init_by_sector_num(size_t sector_num)
     fdb_kvdb_control(&(test_kvdb), FDB_KVDB_CTRL_SET_SEC_SIZE, &sec_size);
     fdb_kvdb_control(&(test_kvdb), FDB_KVDB_CTRL_SET_FILE_MODE, &file_mode);
     fdb_kvdb_control(&(test_kvdb), FDB_KVDB_CTRL_SET_MAX_SIZE, &db_size);
+#ifdef FDB_USING_BLOCK_CACHE
+    {
+        static struct fdb_cache_block cache_blocks[8];
+        struct fdb_block_cache_mem cache_mem = { cache_blocks, sizeof(cache_blocks) };
+
+        fdb_kvdb_control(&(test_kvdb), FDB_KVDB_CTRL_SET_BLOCK_CACHE, &cache_mem);
+    }
+#endif
 
     uassert_true(fdb_kvdb_init(&test_kvdb, "test_kv", TEST_TS_PART_NAME, NULL, NULL) == FDB_NO_ERR);
 }
@@ -249,6 +257,28 @@ static void test_fdb_create_kv_blob(void)
     uassert_buf_equal(&tick, value_buf, sizeof(value_buf));
 }
 
+static void test_fdb_kv_get_ptr(void)
+{
+    rt_tick_t tick = rt_tick_get();
+    struct fdb_blob blob;
+    const void *value;
+    size_t value_len = 0;
+    uint32_t generation = 0;
+
+    uassert_true(fdb_kv_set_blob(&test_kvdb, "ptr_kv", fdb_blob_make(&blob, &tick, sizeof(tick))) == FDB_NO_ERR);
+    value = fdb_kv_get_ptr(&test_kvdb, "ptr_kv", &value_len, &generation);
+#ifdef FDB_USING_FILE_MMAP_MODE
+    uassert_true(value != NULL);
+    uassert_int_equal(value_len, sizeof(tick));
+    uassert_buf_equal(value, &tick, sizeof(tick));
+    uassert_int_equal(generation, fdb_db_generation((fdb_db_t)&test_kvdb));
+#else
+    uassert_true(value == NULL);
+#endif
+    uassert_true(fdb_kv_get_ptr(&test_kvdb, "ptr_kv_not_found", &value_len, NULL) == NULL);
+    uassert_true(fdb_kv_del(&test_kvdb, "ptr_kv") == FDB_NO_ERR);
+}
+
 static void test_fdb_change_kv_blob(void)
 {
     fdb_err_t result = FDB_NO_ERR;
@@ -366,6 +396,250 @@ static void test_fdb_del_kv(void)
     }
 }
 
+static void test_fdb_kv_name_crc_collision(void)
+{
+    /* the two KV names have the same CRC32 */
+    const char *name1 = "k97872", *name2 = "k15860000";
+    char *read_value;
+
+    uassert_int_equal(fdb_calc_crc32(0, name1, strlen(name1)), fdb_calc_crc32(0, name2, strlen(name2)));
+
+    uassert_true(fdb_kv_set(&test_kvdb, name1, "1") == FDB_NO_ERR);
+    /* the missed KV is NOT mixed up with the existing KV */
+    uassert_null(fdb_kv_get(&test_kvdb, name2));
+    read_value = fdb_kv_get(&test_kvdb, name1);
+    uassert_not_null(read_value);
+    uassert_str_equal(read_value, "1");
+
+    uassert_true(fdb_kv_set(&test_kvdb, name2, "2") == FDB_NO_ERR);
+    read_value = fdb_kv_get(&test_kvdb, name2);
+    uassert_not_null(read_value);
+    uassert_str_equal(read_value, "2");
+
+    uassert_true(fdb_kv_del(&test_kvdb, name1) == FDB_NO_ERR);
+    uassert_true(fdb_kv_del(&test_kvdb, name2) == FDB_NO_ERR);
+}
+
+static void test_fdb_set_kv_batch(void)
+{
+    const char *keys[] = {"batch_kv0", "batch_kv1", "batch_kv2", "batch_kv0"};
+    uint32_t values[] = {1, 2, 3, 4}, read_value;
+    struct fdb_blob blobs[FDB_ARRAY_SIZE(keys)], blob;
+    struct fdb_kv kv_obj;
+    size_t i;
+
+    for (i = 0; i < FDB_ARRAY_SIZE(keys); i++) {
+        fdb_blob_make(&blobs[i], &values[i], sizeof(values[i]));
+    }
+    uassert_true(fdb_kv_set_batch(&test_kvdb, keys, blobs, FDB_ARRAY_SIZE(keys)) == FDB_NO_ERR);
+    /* change all KVs of the batch */
+    for (i = 0; i < FDB_ARRAY_SIZE(keys); i++) {
+        values[i] += 10;
+    }
+    uassert_true(fdb_kv_set_batch(&test_kvdb, keys, blobs, FDB_ARRAY_SIZE(keys)) == FDB_NO_ERR);
+
+    fdb_reboot();
+    /* the last value is saved when the name is duplicated in the batch */
+    fdb_kv_get_blob(&test_kvdb, "batch_kv0", fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+    uassert_int_equal(blob.saved.len, sizeof(read_value));
+    uassert_int_equal(read_value, 14);
+    fdb_kv_get_blob(&test_kvdb, "batch_kv1", fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+    uassert_int_equal(blob.saved.len, sizeof(read_value));
+    uassert_int_equal(read_value, 12);
+    fdb_kv_get_blob(&test_kvdb, "batch_kv2", fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+    uassert_int_equal(blob.saved.len, sizeof(read_value));
+    uassert_int_equal(read_value, 13);
+    /* the commit KV was deleted after the batch finished */
+    uassert_null(fdb_kv_get_obj(&test_kvdb, "__batch__", &kv_obj));
+
+    /* deleting KV is not supported in batch, and nothing will be changed */
+    fdb_blob_make(&blobs[1], NULL, 0);
+    uassert_true(fdb_kv_set_batch(&test_kvdb, keys, blobs, FDB_ARRAY_SIZE(keys)) != FDB_NO_ERR);
+    fdb_kv_get_blob(&test_kvdb, "batch_kv0", fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+    uassert_int_equal(read_value, 14);
+
+    for (i = 0; i < 3; i++) {
+        uassert_true(fdb_kv_del(&test_kvdb, keys[i]) == FDB_NO_ERR);
+    }
+}
+
+static void test_fdb_set_kv_batch_cross_sector(void)
+{
+    const char *keys[] = {"batch_kv0", "batch_kv1"};
+    uint32_t values[] = {1, 2}, read_value, old_sec_addr;
+    /* the filler KV is not smaller than each KV of the batch */
+    uint8_t filler[8] = { 0 };
+    struct fdb_blob blobs[FDB_ARRAY_SIZE(keys)], blob;
+    struct fdb_kv kv_obj;
+    size_t i;
+
+    for (i = 0; i < FDB_ARRAY_SIZE(keys); i++) {
+        fdb_blob_make(&blobs[i], &values[i], sizeof(values[i]));
+    }
+    uassert_true(fdb_kv_set_batch(&test_kvdb, keys, blobs, FDB_ARRAY_SIZE(keys)) == FDB_NO_ERR);
+    uassert_not_null(fdb_kv_get_obj(&test_kvdb, keys[0], &kv_obj));
+    old_sec_addr = RT_ALIGN_DOWN(kv_obj.addr.start, TEST_KVDB_SECTOR_SIZE);
+    /* fill the sector, so the next batch is saved in other sector than the old KVs */
+    for (i = 0; i < TEST_KVDB_SECTOR_SIZE / sizeof(filler); i++) {
+        uassert_true(fdb_kv_set_blob(&test_kvdb, "batch_filler", fdb_blob_make(&blob, filler, sizeof(filler))) == FDB_NO_ERR);
+        uassert_not_null(fdb_kv_get_obj(&test_kvdb, "batch_filler", &kv_obj));
+        if (RT_ALIGN_DOWN(kv_obj.addr.start, TEST_KVDB_SECTOR_SIZE) != old_sec_addr) {
+            break;
+        }
+    }
+    for (i = 0; i < FDB_ARRAY_SIZE(keys); i++) {
+        values[i] += 10;
+    }
+    uassert_true(fdb_kv_set_batch(&test_kvdb, keys, blobs, FDB_ARRAY_SIZE(keys)) == FDB_NO_ERR);
+    uassert_not_null(fdb_kv_get_obj(&test_kvdb, keys[0], &kv_obj));
+    uassert_int_not_equal(RT_ALIGN_DOWN(kv_obj.addr.start, TEST_KVDB_SECTOR_SIZE), old_sec_addr);
+
+    fdb_reboot();
+    /* the old KVs in the other sector are deleted */
+    for (i = 0; i < FDB_ARRAY_SIZE(keys); i++) {
+        fdb_kv_get_blob(&test_kvdb, keys[i], fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+        uassert_int_equal(blob.saved.len, sizeof(read_value));
+        uassert_int_equal(read_value, values[i]);
+        uassert_true(fdb_kv_del(&test_kvdb, keys[i]) == FDB_NO_ERR);
+        uassert_null(fdb_kv_get_obj(&test_kvdb, keys[i], &kv_obj));
+    }
+    uassert_true(fdb_kv_del(&test_kvdb, "batch_filler") == FDB_NO_ERR);
+}
+
+static void test_fdb_kvdb_flush(void)
+{
+    uint32_t value, read_value = 0;
+    struct fdb_blob blob;
+
+    /* the KV will be saved in write buffer first when FDB_KV_WRITE_BUF_SIZE is enabled */
+    for (value = 0; value < 10; value++) {
+        uassert_true(fdb_kv_set_blob(&test_kvdb, "flush_kv", fdb_blob_make(&blob, &value, sizeof(value))) == FDB_NO_ERR);
+    }
+    fdb_kv_get_blob(&test_kvdb, "flush_kv", fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+    uassert_int_equal(blob.saved.len, sizeof(read_value));
+    uassert_int_equal(read_value, 9);
+
+    uassert_true(fdb_kvdb_flush(&test_kvdb) == FDB_NO_ERR);
+    fdb_reboot();
+    read_value = 0;
+    fdb_kv_get_blob(&test_kvdb, "flush_kv", fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+    uassert_int_equal(blob.saved.len, sizeof(read_value));
+    uassert_int_equal(read_value, 9);
+
+    uassert_true(fdb_kv_del(&test_kvdb, "flush_kv") == FDB_NO_ERR);
+    fdb_kv_get_blob(&test_kvdb, "flush_kv", fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+    uassert_int_equal(blob.saved.len, 0);
+}
+
+static void test_fdb_kvdb_durability(void)
+{
+    uint32_t value, read_value = 0, group_sync = 4;
+    fdb_durability_t durability = FDB_DURABILITY_NONE;
+    fdb_db_t dbs[] = {(fdb_db_t)&test_kvdb};
+    struct fdb_blob blob;
+
+    fdb_kvdb_control(&test_kvdb, FDB_KVDB_CTRL_SET_DURABILITY, &durability);
+    for (value = 0; value < 10; value++) {
+        uassert_true(fdb_kv_set_blob(&test_kvdb, "durability_kv", fdb_blob_make(&blob, &value, sizeof(value))) == FDB_NO_ERR);
+    }
+    uassert_true(fdb_db_sync((fdb_db_t)&test_kvdb) == FDB_NO_ERR);
+    for (; value < 15; value++) {
+        uassert_true(fdb_kv_set_blob(&test_kvdb, "durability_kv", fdb_blob_make(&blob, &value, sizeof(value))) == FDB_NO_ERR);
+    }
+    uassert_true(fdb_db_sync_multi(dbs, FDB_ARRAY_SIZE(dbs)) == FDB_NO_ERR);
+#ifdef FDB_USING_FILE_MODE
+    uassert_int_equal(test_kvdb.parent.pending_sync, 0);
+#endif
+
+    durability = FDB_DURABILITY_GROUP;
+    fdb_kvdb_control(&test_kvdb, FDB_KVDB_CTRL_SET_DURABILITY, &durability);
+    fdb_kvdb_control(&test_kvdb, FDB_KVDB_CTRL_SET_GROUP_SYNC, &group_sync);
+    for (; value < 20; value++) {
+        uassert_true(fdb_kv_set_blob(&test_kvdb, "durability_kv", fdb_blob_make(&blob, &value, sizeof(value))) == FDB_NO_ERR);
+    }
+    /* the deferred writes are synced when the level is changed */
+    durability = FDB_DURABILITY_STRICT;
+    fdb_kvdb_control(&test_kvdb, FDB_KVDB_CTRL_SET_DURABILITY, &durability);
+#ifdef FDB_USING_FILE_MODE
+    uassert_int_equal(test_kvdb.parent.pending_sync, 0);
+#endif
+    fdb_reboot();
+    fdb_kv_get_blob(&test_kvdb, "durability_kv", fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+    uassert_int_equal(blob.saved.len, sizeof(read_value));
+    uassert_int_equal(read_value, 19);
+
+    uassert_true(fdb_kv_del(&test_kvdb, "durability_kv") == FDB_NO_ERR);
+}
+
+static void test_fdb_kvdb_gc_step(void)
+{
+    uint32_t value, read_value = 0;
+    struct fdb_blob blob;
+    size_t step;
+
+    /* the old values are garbage now */
+    for (value = 0; value < 100; value++) {
+        uassert_true(fdb_kv_set_blob(&test_kvdb, "gc_step_kv", fdb_blob_make(&blob, &value, sizeof(value))) == FDB_NO_ERR);
+    }
+    fdb_kvdb_flush(&test_kvdb);
+    /* collect all dirty sectors step by step */
+    for (step = 0; step < 1000 && fdb_kvdb_gc_step(&test_kvdb, 0); step++);
+    uassert_true(step < 1000);
+    uassert_false(fdb_kvdb_gc_step(&test_kvdb, 0));
+
+    fdb_reboot();
+    fdb_kv_get_blob(&test_kvdb, "gc_step_kv", fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+    uassert_int_equal(blob.saved.len, sizeof(read_value));
+    uassert_int_equal(read_value, 99);
+    uassert_true(fdb_kv_del(&test_kvdb, "gc_step_kv") == FDB_NO_ERR);
+}
+
+static void test_fdb_kv_lookup_after_gc(void)
+{
+#define TEST_LOOKUP_KV_NUM             24
+#define TEST_LOOKUP_ROUND_NUM          16
+    char name[FDB_KV_NAME_MAX];
+    uint32_t value, read_value;
+    struct fdb_blob blob;
+    size_t i, round;
+
+    /* change all KVs round by round, the old KVs will be moved or collected by GC */
+    for (round = 0; round < TEST_LOOKUP_ROUND_NUM; round++) {
+        for (i = 0; i < TEST_LOOKUP_KV_NUM; i++) {
+            snprintf(name, sizeof(name), "lookup_kv%d", (int)i);
+            value = round * TEST_LOOKUP_KV_NUM + i;
+            uassert_true(fdb_kv_set_blob(&test_kvdb, name, fdb_blob_make(&blob, &value, sizeof(value))) == FDB_NO_ERR);
+        }
+    }
+    /* delete the odd KVs */
+    for (i = 1; i < TEST_LOOKUP_KV_NUM; i += 2) {
+        snprintf(name, sizeof(name), "lookup_kv%d", (int)i);
+        uassert_true(fdb_kv_del(&test_kvdb, name) == FDB_NO_ERR);
+    }
+    /* look up all KVs before and after the remount, the index is rebuilt when it's enabled */
+    for (round = 0; round < 2; round++) {
+        for (i = 0; i < TEST_LOOKUP_KV_NUM; i++) {
+            snprintf(name, sizeof(name), "lookup_kv%d", (int)i);
+            read_value = 0;
+            fdb_kv_get_blob(&test_kvdb, name, fdb_blob_make(&blob, &read_value, sizeof(read_value)));
+            if (i % 2) {
+                uassert_int_equal(blob.saved.len, 0);
+            } else {
+                uassert_int_equal(blob.saved.len, sizeof(read_value));
+                uassert_int_equal(read_value, (TEST_LOOKUP_ROUND_NUM - 1) * TEST_LOOKUP_KV_NUM + i);
+            }
+        }
+        if (round == 0) {
+            fdb_reboot();
+        }
+    }
+
+    for (i = 0; i < TEST_LOOKUP_KV_NUM; i += 2) {
+        snprintf(name, sizeof(name), "lookup_kv%d", (int)i);
+        uassert_true(fdb_kv_del(&test_kvdb, name) == FDB_NO_ERR);
+    }
+}
+
 static int iter_all_kv(fdb_kvdb_t db, struct test_kv *kv_tbl, size_t len)
 {
     struct fdb_kv_iterator iterator;
@@ -935,11 +1209,64 @@ static void test_fdb_scale_up(void)
     test_check_fdb_by_kvs(old_kv_tbl, FDB_ARRAY_SIZE(old_kv_tbl));
 }
 
+static void test_fdb_file_erased_data(void)
+{
+    /* use the last sector, the whole database is formatted after this test */
+    uint32_t sec_addr = TEST_KVDB_SECTOR_SIZE * (TEST_KVDB_SECTOR_NUM - 1), data_addr = sec_addr + TEST_KVDB_SECTOR_SIZE / 2;
+    uint8_t buf[64], data[32];
+    size_t i;
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+    /* the erased sector file is empty, the data after the end of file is read as erased data */
+    uassert_true(_fdb_flash_erase((fdb_db_t)&test_kvdb, sec_addr, TEST_KVDB_SECTOR_SIZE) == FDB_NO_ERR);
+    uassert_true(_fdb_flash_read((fdb_db_t)&test_kvdb, sec_addr + TEST_KVDB_SECTOR_SIZE - sizeof(buf), buf, sizeof(buf)) == FDB_NO_ERR);
+    for (i = 0; i < sizeof(buf); i++) {
+        uassert_int_equal(buf[i], FDB_BYTE_ERASED);
+    }
+    /* write after the end of file, the file is extended and the gap is filled with erased data */
+    uassert_true(_fdb_flash_write((fdb_db_t)&test_kvdb, data_addr, data, sizeof(data), true) == FDB_NO_ERR);
+    uassert_true(_fdb_flash_read((fdb_db_t)&test_kvdb, data_addr - sizeof(buf), buf, sizeof(buf)) == FDB_NO_ERR);
+    for (i = 0; i < sizeof(buf); i++) {
+        uassert_int_equal(buf[i], FDB_BYTE_ERASED);
+    }
+    uassert_true(_fdb_flash_read((fdb_db_t)&test_kvdb, sec_addr, buf, sizeof(buf)) == FDB_NO_ERR);
+    for (i = 0; i < sizeof(buf); i++) {
+        uassert_int_equal(buf[i], FDB_BYTE_ERASED);
+    }
+    uassert_true(_fdb_flash_read((fdb_db_t)&test_kvdb, data_addr, buf, sizeof(buf)) == FDB_NO_ERR);
+    uassert_buf_equal(buf, data, sizeof(data));
+    for (i = sizeof(data); i < sizeof(buf); i++) {
+        uassert_int_equal(buf[i], FDB_BYTE_ERASED);
+    }
+
+    uassert_true(fdb_kv_set_default(&test_kvdb) == FDB_NO_ERR);
+}
+
 static void test_fdb_kvdb_set_default(void)
 {
     uassert_true(fdb_kv_set_default(&test_kvdb) == FDB_NO_ERR);
 }
 
+static void test_fdb_calc_crc32(void)
+{
+    uint8_t buf[300];
+    size_t i;
+
+    /* the CRC-32 (IEEE 802.3) check value, it MUST be same for all CRC32 algorithm */
+    uassert_int_equal(fdb_calc_crc32(0, "123456789", 9), 0xCBF43926);
+
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)(i * 7 + 3);
+    }
+    uassert_int_equal(fdb_calc_crc32(0, buf, sizeof(buf)), 0xDE0E57CE);
+    /* accumulate the CRC32 by different split size and alignment */
+    for (i = 0; i <= sizeof(buf); i += 13) {
+        uassert_int_equal(fdb_calc_crc32(fdb_calc_crc32(0, buf, i), buf + i, sizeof(buf) - i), 0xDE0E57CE);
+    }
+}
+
 
 static rt_err_t utest_tc_init(void)
 {
@@ -960,17 +1287,27 @@ static rt_err_t utest_tc_cleanup(void)
 
 static void testcase(void)
 {
+    UTEST_UNIT_RUN(test_fdb_calc_crc32);
     UTEST_UNIT_RUN(test_fdb_kvdb_init);
     UTEST_UNIT_RUN(test_fdb_kvdb_init_check);
     UTEST_UNIT_RUN(test_fdb_create_kv_blob);
+    UTEST_UNIT_RUN(test_fdb_kv_get_ptr);
     UTEST_UNIT_RUN(test_fdb_change_kv_blob);
     UTEST_UNIT_RUN(test_fdb_del_kv_blob);
     UTEST_UNIT_RUN(test_fdb_create_kv);
     UTEST_UNIT_RUN(test_fdb_change_kv);
     UTEST_UNIT_RUN(test_fdb_del_kv);
+    UTEST_UNIT_RUN(test_fdb_kv_name_crc_collision);
+    UTEST_UNIT_RUN(test_fdb_set_kv_batch);
+    UTEST_UNIT_RUN(test_fdb_set_kv_batch_cross_sector);
+    UTEST_UNIT_RUN(test_fdb_kvdb_flush);
+    UTEST_UNIT_RUN(test_fdb_kvdb_durability);
+    UTEST_UNIT_RUN(test_fdb_kvdb_gc_step);
+    UTEST_UNIT_RUN(test_fdb_kv_lookup_after_gc);
     UTEST_UNIT_RUN(test_fdb_gc);
     UTEST_UNIT_RUN(test_fdb_gc2);
     UTEST_UNIT_RUN(test_fdb_scale_up);
+    UTEST_UNIT_RUN(test_fdb_file_erased_data);
     UTEST_UNIT_RUN(test_fdb_kvdb_set_default);
     UTEST_UNIT_RUN(test_fdb_kvdb_deinit);
 }
@@ -97,6 +97,14 @@ static void test_fdb_tsdb_init_ex(void)
     fdb_tsdb_control((fdb_tsdb_t)&(test_tsdb), FDB_TSDB_CTRL_SET_SEC_SIZE, &sec_size);
     fdb_tsdb_control((fdb_tsdb_t)&(test_tsdb), FDB_TSDB_CTRL_SET_FILE_MODE, &file_mode);
     fdb_tsdb_control((fdb_tsdb_t)&(test_tsdb), FDB_TSDB_CTRL_SET_MAX_SIZE, &db_size);
+#ifdef FDB_USING_BLOCK_CACHE
+    {
+        static struct fdb_cache_block cache_blocks[8];
+        struct fdb_block_cache_mem cache_mem = { cache_blocks, sizeof(cache_blocks) };
+
+        fdb_tsdb_control((fdb_tsdb_t)&(test_tsdb), FDB_TSDB_CTRL_SET_BLOCK_CACHE, &cache_mem);
+    }
+#endif
 
     uassert_true(fdb_tsdb_init(&test_tsdb, "test_ts", TEST_TS_PART_NAME, get_time, 128, NULL) == FDB_NO_ERR);
 }
@@ -151,6 +159,32 @@ static void test_fdb_tsl_iter(void)
     fdb_tsl_iter(&test_tsdb, test_fdb_tsl_iter_cb, NULL);
 }
 
+static bool test_fdb_tsl_get_ptr_cb(fdb_tsl_t tsl, void *arg)
+{
+    char data[sizeof(logbuf)];
+    const void *ptr;
+    size_t log_len = 0;
+
+    ptr = fdb_tsl_get_ptr(&test_tsdb, tsl, &log_len, NULL);
+#ifdef FDB_USING_FILE_MMAP_MODE
+    uassert_true(ptr != NULL);
+    uassert_int_equal(log_len, tsl->log_len);
+    rt_memcpy(data, ptr, log_len);
+    data[log_len] = '\0';
+    uassert_true(tsl->time == atoi(data));
+#else
+    (void)data;
+    uassert_true(ptr == NULL);
+#endif
+
+    return false;
+}
+
+static void test_fdb_tsl_get_ptr(void)
+{
+    fdb_tsl_iter(&test_tsdb, test_fdb_tsl_get_ptr_cb, NULL);
+}
+
 static void test_fdb_tsl_iter_by_time(void)
 {
     fdb_time_t from = 0, to = TEST_TS_COUNT * TEST_TIME_STEP - 1;
@@ -173,6 +207,11 @@ static void test_fdb_tsl_query_count(void)
                (int)from, (int)to, (unsigned)count, TEST_TS_COUNT);
 
     uassert_true(count == TEST_TS_COUNT);
+    /* count the TSL of all status */
+    uassert_int_equal(fdb_tsl_query_count_all(&test_tsdb, from, to), TEST_TS_COUNT);
+    uassert_int_equal(fdb_tsl_query_count_all(&test_tsdb, to - 3, from + 3), TEST_TS_COUNT - 3);
+    uassert_int_equal(fdb_tsl_query_count_all(&test_tsdb, to + 1, to + 2), 0);
+    uassert_int_equal(fdb_tsl_query_count(&test_tsdb, from + 3, to - 3, FDB_TSL_WRITE), TEST_TS_COUNT - 3);
 }
 
 static bool est_fdb_tsl_set_status_cb(fdb_tsl_t tsl, void *arg)
@@ -188,15 +227,49 @@ static bool est_fdb_tsl_set_status_cb(fdb_tsl_t tsl, void *arg)
     return false;
 }
 
+static bool test_fdb_tsl_set_lower_status_cb(fdb_tsl_t tsl, void *arg)
+{
+    fdb_tsdb_t db = arg;
+
+    if (tsl->status == FDB_TSL_DELETED) {
+        /* the status maybe go back or NOT by the storage */
+        fdb_tsl_set_status(db, tsl, FDB_TSL_WRITE);
+    }
+
+    return false;
+}
+
+static bool test_fdb_tsl_count_deleted_cb(fdb_tsl_t tsl, void *arg)
+{
+    size_t *count = arg;
+
+    if (tsl->status == FDB_TSL_DELETED) {
+        (*count)++;
+    }
+
+    return false;
+}
+
 static void test_fdb_tsl_set_status(void)
 {
     fdb_time_t from = 0, to = TEST_TS_COUNT * TEST_TIME_STEP;
+    size_t deleted_count = 0;
 
     fdb_reboot();
     fdb_tsl_iter_by_time(&test_tsdb, from, to, est_fdb_tsl_set_status_cb, &test_tsdb);
 
     uassert_true(fdb_tsl_query_count(&test_tsdb, from, to, FDB_TSL_USER_STATUS1) == TEST_TS_USER_STATUS1_COUNT);
     uassert_true(fdb_tsl_query_count(&test_tsdb, from, to, FDB_TSL_DELETED) == TEST_TS_DELETED_COUNT);
+    /* the status count is updated when setting the status */
+    uassert_true(fdb_tsl_query_count(&test_tsdb, from, to, FDB_TSL_WRITE) == 0);
+    uassert_true(fdb_tsl_query_count_all(&test_tsdb, from, to) == TEST_TS_COUNT);
+    uassert_true(fdb_tsl_query_count(&test_tsdb, TEST_TS_USER_STATUS1_COUNT * TEST_TIME_STEP, to, FDB_TSL_USER_STATUS1) == 1);
+
+    fdb_tsl_iter_by_time(&test_tsdb, from, to, test_fdb_tsl_set_lower_status_cb, &test_tsdb);
+    fdb_tsl_iter_by_time(&test_tsdb, from, to, test_fdb_tsl_count_deleted_cb, &deleted_count);
+    uassert_true(fdb_tsl_query_count(&test_tsdb, from, to, FDB_TSL_DELETED) == deleted_count);
+    uassert_true(fdb_tsl_query_count(&test_tsdb, from, to, FDB_TSL_WRITE) == TEST_TS_DELETED_COUNT - deleted_count);
+    uassert_true(fdb_tsl_query_count(&test_tsdb, from, to, FDB_TSL_USER_STATUS1) == TEST_TS_USER_STATUS1_COUNT);
 }
 
 static bool test_fdb_tsl_clean_cb(fdb_tsl_t tsl, void *arg)
@@ -449,6 +522,213 @@ static void test_fdb_tsl_iter_by_time_1(void)
     test_fdb_tsl_sector_bound_test(2, 2);
 }
 
+static bool get_oldest_time_cb(fdb_tsl_t tsl, void *arg)
+{
+    *(fdb_time_t *)arg = tsl->time;
+
+    return true;
+}
+
+static void test_fdb_tsl_iter_by_time_rollover(void)
+{
+    struct fdb_blob blob;
+    fdb_durability_t durability = FDB_DURABILITY_NONE;
+    int data;
+
+    fdb_tsl_clean(&test_tsdb);
+    /* make test data for more than all 16 sectors, so the database is rollover */
+    fdb_tsdb_control(&test_tsdb, FDB_TSDB_CTRL_SET_DURABILITY, &durability);
+    for (data = 0; data < 20 * _TSIL_PER_SECTOR; data++) {
+        fdb_tsl_append(&test_tsdb, fdb_blob_make(&blob, &data, sizeof(data)));
+    }
+
+    fdb_reboot();
+
+    test_db_start_time = 0x7FFFFFFF;
+    fdb_tsl_iter(&test_tsdb, get_oldest_time_cb, &test_db_start_time);
+    fdb_tsdb_control(&test_tsdb, FDB_TSDB_CTRL_GET_LAST_TIME, &test_db_end_time);
+    uassert_true(test_db_start_time > 0);
+
+    /* check the database bound */
+    test_tsdb_data_by_time(test_db_start_time - 1, test_db_end_time + 1);
+    test_tsdb_data_by_time(test_db_end_time + 1, test_db_start_time - 1);
+    test_tsdb_data_by_time(test_db_start_time - 2, test_db_start_time - 1);
+    test_tsdb_data_by_time(test_db_end_time + 2, test_db_end_time + 1);
+    /* check the ranges in the middle of the database */
+    test_tsdb_data_by_time(test_db_start_time + 3, test_db_end_time - 3);
+    test_tsdb_data_by_time(test_db_end_time - 3, test_db_start_time + 3);
+    test_tsdb_data_by_time((test_db_start_time + test_db_end_time) / 2, test_db_end_time);
+    test_tsdb_data_by_time((test_db_start_time + test_db_end_time) / 2, test_db_start_time);
+    test_tsdb_data_by_time(test_db_end_time - 5, test_db_end_time + 1);
+    test_tsdb_data_by_time(test_db_start_time + 5, test_db_start_time - 1);
+
+    /* restore the default durability level for the next tests */
+    durability = FDB_DURABILITY_STRICT;
+    fdb_tsdb_control(&test_tsdb, FDB_TSDB_CTRL_SET_DURABILITY, &durability);
+}
+
+static bool check_batch_cb(fdb_tsl_t tsl, void *arg)
+{
+    int *count = arg, data = -1;
+    struct fdb_blob blob;
+
+    fdb_blob_read((fdb_db_t) &test_tsdb, fdb_tsl_to_blob(tsl, fdb_blob_make(&blob, &data, sizeof(data))));
+    uassert_true(tsl->status == FDB_TSL_WRITE);
+    uassert_true(data == *count);
+    uassert_true(tsl->time == (*count + 1) * TEST_TIME_STEP);
+    (*count)++;
+
+    return false;
+}
+
+static void test_fdb_tsl_append_batch(void)
+{
+    static int data[_TSIL_PER_SECTOR * 2];
+    static struct fdb_blob blobs[_TSIL_PER_SECTOR * 2];
+    static fdb_time_t timestamps[_TSIL_PER_SECTOR * 2];
+    int i, count = 0, half = _TSIL_PER_SECTOR;
+
+    fdb_tsl_clean(&test_tsdb);
+    for (i = 0; i < _TSIL_PER_SECTOR * 2; i++) {
+        data[i] = i;
+        fdb_blob_make(&blobs[i], &data[i], sizeof(data[i]));
+        timestamps[i] = (i + 1) * TEST_TIME_STEP;
+    }
+    /* the batch is more than one sector */
+    uassert_true(fdb_tsl_append_batch(&test_tsdb, blobs, timestamps, half + half / 2) == FDB_NO_ERR);
+    /* the logs after the wrong timestamp are dropped */
+    timestamps[half * 2 - 2] = timestamps[half * 2 - 3];
+    uassert_true(fdb_tsl_append_batch(&test_tsdb, &blobs[half + half / 2], &timestamps[half + half / 2],
+            half * 2 - (half + half / 2)) == FDB_WRITE_ERR);
+
+    fdb_reboot();
+
+    fdb_tsl_iter(&test_tsdb, check_batch_cb, &count);
+    uassert_int_equal(count, half * 2 - 2);
+    uassert_int_equal(fdb_tsl_query_count(&test_tsdb, 0, timestamps[half], FDB_TSL_WRITE), half + 1);
+}
+
+static void test_fdb_tsl_cursor(void)
+{
+    struct fdb_tsl_cursor cursor;
+    struct fdb_blob blob;
+    fdb_time_t saved_time;
+    int count = 0, half = _TSIL_PER_SECTOR, data;
+
+    /* the TSL from test_fdb_tsl_append_batch: data 0 ~ (half * 2 - 3), time (data + 1) * TEST_TIME_STEP */
+    fdb_tsl_cursor_init(&test_tsdb, &cursor);
+    while (fdb_tsl_cursor_next(&test_tsdb, &cursor)) {
+        check_batch_cb(&cursor.curr_tsl, &count);
+    }
+    uassert_int_equal(count, half * 2 - 2);
+    /* append a new TSL when the cursor is at the end */
+    data = count;
+    uassert_true(fdb_tsl_append_with_ts(&test_tsdb, fdb_blob_make(&blob, &data, sizeof(data)),
+            (count + 1) * TEST_TIME_STEP) == FDB_NO_ERR);
+    uassert_true(fdb_tsl_cursor_next(&test_tsdb, &cursor));
+    check_batch_cb(&cursor.curr_tsl, &count);
+    uassert_false(fdb_tsl_cursor_next(&test_tsdb, &cursor));
+
+    /* seek to the middle of the database, it's between two sectors */
+    fdb_tsl_cursor_seek(&test_tsdb, &cursor, (half + 1) * TEST_TIME_STEP);
+    uassert_true(fdb_tsl_cursor_prev(&test_tsdb, &cursor));
+    uassert_true(cursor.curr_tsl.time == half * TEST_TIME_STEP);
+    uassert_true(fdb_tsl_cursor_prev(&test_tsdb, &cursor));
+    uassert_true(cursor.curr_tsl.time == (half - 1) * TEST_TIME_STEP);
+    uassert_true(fdb_tsl_cursor_next(&test_tsdb, &cursor));
+    uassert_true(cursor.curr_tsl.time == (half - 1) * TEST_TIME_STEP);
+    /* resume the saved cursor by seek */
+    saved_time = cursor.time;
+    fdb_reboot();
+    fdb_tsl_cursor_init(&test_tsdb, &cursor);
+    fdb_tsl_cursor_seek(&test_tsdb, &cursor, saved_time);
+    count = half - 1;
+    while (fdb_tsl_cursor_next(&test_tsdb, &cursor)) {
+        check_batch_cb(&cursor.curr_tsl, &count);
+    }
+    uassert_int_equal(count, half * 2 - 1);
+    /* iterate to the oldest TSL in reverse */
+    while (fdb_tsl_cursor_prev(&test_tsdb, &cursor)) {
+        uassert_true(cursor.curr_tsl.time == count * TEST_TIME_STEP);
+        count--;
+    }
+    uassert_int_equal(count, 0);
+}
+
+static bool get_int_value(const void *log, size_t len, double *value)
+{
+    int data;
+
+    if (len < sizeof(data)) {
+        return false;
+    }
+    memcpy(&data, log, sizeof(data));
+    *value = data;
+
+    return true;
+}
+
+static bool delete_tsl_cb(fdb_tsl_t tsl, void *arg)
+{
+    fdb_tsl_set_status(&test_tsdb, tsl, FDB_TSL_DELETED);
+
+    return true;
+}
+
+static void test_tsl_aggregate(int from, int to, int deleted)
+{
+    struct fdb_tsl_aggr aggr;
+    double sum = 0;
+    int i, count = 0;
+
+    for (i = from; i <= to; i++) {
+        if (i != deleted) {
+            sum += i;
+            count++;
+        }
+    }
+    uassert_true(fdb_tsl_aggregate(&test_tsdb, (from + 1) * TEST_TIME_STEP, (to + 1) * TEST_TIME_STEP, &aggr) == FDB_NO_ERR);
+    uassert_int_equal(aggr.count, count);
+    uassert_true(aggr.sum == sum);
+    uassert_true(aggr.min == (from == deleted ? from + 1 : from));
+    uassert_true(aggr.max == (to == deleted ? to - 1 : to));
+    /* the reverse time range */
+    uassert_true(fdb_tsl_aggregate(&test_tsdb, (to + 1) * TEST_TIME_STEP + 1, (from + 1) * TEST_TIME_STEP - 1, &aggr) == FDB_NO_ERR);
+    uassert_int_equal(aggr.count, count);
+    uassert_true(aggr.sum == sum);
+}
+
+static void test_fdb_tsl_aggregate(void)
+{
+    struct fdb_tsl_aggr aggr;
+    struct fdb_blob blob;
+    int half = _TSIL_PER_SECTOR, last = half * 2 - 2, data;
+
+    /* the TSL from test_fdb_tsl_cursor: data 0 ~ (half * 2 - 2), time (data + 1) * TEST_TIME_STEP */
+    fdb_tsdb_control(&test_tsdb, FDB_TSDB_CTRL_SET_AGGR_VALUE, (void *)get_int_value);
+    test_tsl_aggregate(0, last, -1);
+    test_tsl_aggregate(1, half, -1);
+    test_tsl_aggregate(half - 1, last - 1, -1);
+    /* the summary is updated when appending */
+    data = last + 1;
+    uassert_true(fdb_tsl_append_with_ts(&test_tsdb, fdb_blob_make(&blob, &data, sizeof(data)),
+            (data + 1) * TEST_TIME_STEP) == FDB_NO_ERR);
+    last = data;
+    test_tsl_aggregate(0, last, -1);
+    uassert_true(fdb_tsl_aggregate(&test_tsdb, 0, 1, &aggr) == FDB_NO_ERR);
+    uassert_int_equal(aggr.count, 0);
+    uassert_true(fdb_tsl_aggregate(&test_tsdb, (last + 2) * TEST_TIME_STEP, INT32_MAX, &aggr) == FDB_NO_ERR);
+    uassert_int_equal(aggr.count, 0);
+    /* the deleted TSL is NOT aggregated */
+    fdb_tsl_iter_by_time(&test_tsdb, (half + 1) * TEST_TIME_STEP, (half + 1) * TEST_TIME_STEP, delete_tsl_cb, NULL);
+    test_tsl_aggregate(0, last, half);
+    test_tsl_aggregate(half, last, half);
+    /* only count the TSL without the value get function */
+    fdb_tsdb_control(&test_tsdb, FDB_TSDB_CTRL_SET_AGGR_VALUE, NULL);
+    uassert_true(fdb_tsl_aggregate(&test_tsdb, 0, INT32_MAX, &aggr) == FDB_NO_ERR);
+    uassert_int_equal(aggr.count, last);
+}
+
 static void test_fdb_github_issue_249(void)
 {
     if (access("storage_tsdb", 0) < 0)
@@ -504,11 +784,16 @@ static void testcase(void)
     UTEST_UNIT_RUN(test_fdb_tsl_clean);
     UTEST_UNIT_RUN(test_fdb_tsl_append);
     UTEST_UNIT_RUN(test_fdb_tsl_iter);
+    UTEST_UNIT_RUN(test_fdb_tsl_get_ptr);
     UTEST_UNIT_RUN(test_fdb_tsl_iter_by_time);
     UTEST_UNIT_RUN(test_fdb_tsl_query_count);
     UTEST_UNIT_RUN(test_fdb_tsl_set_status);
     UTEST_UNIT_RUN(test_fdb_tsl_clean);
     UTEST_UNIT_RUN(test_fdb_tsl_iter_by_time_1);
+    UTEST_UNIT_RUN(test_fdb_tsl_iter_by_time_rollover);
+    UTEST_UNIT_RUN(test_fdb_tsl_append_batch);
+    UTEST_UNIT_RUN(test_fdb_tsl_cursor);
+    UTEST_UNIT_RUN(test_fdb_tsl_aggregate);
     UTEST_UNIT_RUN(test_fdb_tsdb_deinit);
 
     UTEST_UNIT_RUN(test_fdb_github_issue_249);